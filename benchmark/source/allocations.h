@@ -0,0 +1,32 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+// allocations are counted by the implementation shared with the tests
+#include "../../test/source/allocations.h"
+
+namespace allocations {
+
+  /**
+   * Reports the heap allocations made by the current thread during its lifetime as
+   * per-iteration counters.
+   * Create it right before the benchmark loop.
+   */
+  class Reporter {
+  private:
+    benchmark::State &state;
+    Count start;
+
+  public:
+    explicit Reporter(benchmark::State &s) : state(s), start(current()) {}
+
+    ~Reporter() {
+      auto end = current();
+      state.counters["allocs/op"] = benchmark::Counter(double(end.allocations - start.allocations),
+                                                       benchmark::Counter::kAvgIterations);
+      state.counters["bytes/op"] = benchmark::Counter(double(end.bytes - start.bytes),
+                                                      benchmark::Counter::kAvgIterations);
+    }
+  };
+
+}  // namespace allocations
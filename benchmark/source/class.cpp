@@ -0,0 +1,259 @@
+#include <benchmark/benchmark.h>
+#include <glue/array.h>
+#include <glue/batch.h>
+#include <glue/class.h>
+#include <glue/static_class.h>
+
+#include <vector>
+
+#include "allocations.h"
+
+using namespace glue;
+
+namespace {
+
+  struct A {
+    int value = 0;
+    int add(int x) const { return value + x; }
+  };
+
+  struct B : public A {};
+
+  auto createAClass() {
+    return createClass<A>().addConstructor<>().addMethod("add", &A::add).addMember("value",
+                                                                                   &A::value);
+  }
+
+  auto createStaticAClass() {
+    return createStaticClass<A>(bind::constructor<>(), bind::method("add", &A::add),
+                                bind::member("value", &A::value));
+  }
+
+  void instanceMethodCall(benchmark::State &state) {
+    auto instance = createAClass().construct();
+    Key key = "add";
+    allocations::Reporter reporter(state);
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(instance[key](1));
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  void staticInstanceMethodCall(benchmark::State &state) {
+    auto map = createStaticAClass();
+    Instance instance(map, A());
+    Key key = "add";
+    allocations::Reporter reporter(state);
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(instance[key](1));
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  void inheritedMethodCall(benchmark::State &state) {
+    auto gA = createAClass();
+    auto gB = createClass<B>(WithBases<A>()).addConstructor<>().setExtends(gA);
+    auto instance = gB.construct();
+    Key key = "add";
+    allocations::Reporter reporter(state);
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(instance[key](1));
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  void frozenInheritedMethodCall(benchmark::State &state) {
+    auto gA = createAClass().freeze();
+    auto gB = createClass<B>(WithBases<A>()).addConstructor<>().setExtends(gA).freeze();
+    auto instance = gB.construct();
+    Key key = "add";
+    allocations::Reporter reporter(state);
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(instance[key](1));
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  void boundMethodCall(benchmark::State &state) {
+    auto instance = createAClass().construct();
+    auto method = instance.method("add");
+    allocations::Reporter reporter(state);
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(method(1));
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  void typedMethodCall(benchmark::State &state) {
+    auto instance = createAClass().construct();
+    Key key = "add";
+    allocations::Reporter reporter(state);
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(instance.call<int>(key, 1));
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  void inlineMethodCall(benchmark::State &state) {
+    auto instance = createAClass().construct();
+    Key key = "add";
+    allocations::Reporter reporter(state);
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(instance.invoke(key, 1));
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  void nativeMethodCall(benchmark::State &state) {
+    A a;
+    allocations::Reporter reporter(state);
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(a);
+      benchmark::DoNotOptimize(a.add(1));
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  void memberGetterRead(benchmark::State &state) {
+    auto instance = createAClass().construct();
+    Key key = "value";
+    allocations::Reporter reporter(state);
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(instance[key]());
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  void fieldRead(benchmark::State &state) {
+    auto instance = createAClass().construct();
+    std::vector<Key> fields{"value"};
+    allocations::Reporter reporter(state);
+    for (auto _ : state) {
+      int value;
+      readFields(instance, fields, &value);
+      benchmark::DoNotOptimize(value);
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  void batchedMethodCall(benchmark::State &state) {
+    auto gA = createAClass();
+    std::vector<Instance> instances;
+    for (int64_t i = 0; i < state.range(0); ++i) instances.push_back(gA.construct());
+    std::vector<Any> results(instances.size());
+    AnyArguments arguments{Any(1)};
+    Key key = "add";
+    allocations::Reporter reporter(state);
+    for (auto _ : state) {
+      invokeAll(instances.data(), instances.size(), key, arguments, results.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+  }
+
+  void classConstruct(benchmark::State &state) {
+    auto gA = createAClass();
+    allocations::Reporter reporter(state);
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(gA.construct());
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  void classCreate(benchmark::State &state) {
+    allocations::Reporter reporter(state);
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(createAClass());
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  void staticClassCreate(benchmark::State &state) {
+    allocations::Reporter reporter(state);
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(createStaticAClass());
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  void arrayElementAccess(benchmark::State &state) {
+    auto array = createArrayClass<std::vector<int>>().construct();
+    auto size = size_t(state.range(0));
+    for (size_t i = 0; i < size; ++i) {
+      array["push"](int(i));
+    }
+    Key get = "get";
+    allocations::Reporter reporter(state);
+    for (auto _ : state) {
+      for (size_t i = 0; i < size; ++i) {
+        benchmark::DoNotOptimize(array[get](i));
+      }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+  }
+
+  void arrayBufferAccess(benchmark::State &state) {
+    auto array = createArrayClass<std::vector<int>>().construct();
+    array["resize"](size_t(state.range(0)));
+    allocations::Reporter reporter(state);
+    for (auto _ : state) {
+      auto buffer = array["buffer"]().get<ArrayBuffer>();
+      auto data = buffer.as<int>();
+      for (size_t i = 0; i < buffer.size; ++i) {
+        benchmark::DoNotOptimize(data[i]);
+      }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+  }
+
+  void arrayBatchIteration(benchmark::State &state) {
+    auto array = createArrayClass<std::vector<int>>().construct();
+    array["resize"](size_t(state.range(0)));
+    auto cursorClass = createCursorClass<std::vector<int>>();
+    Key nextBatch = "nextBatch";
+    allocations::Reporter reporter(state);
+    for (auto _ : state) {
+      Instance cursor(cursorClass.data, array["cursor"]());
+      while (true) {
+        auto batch = cursor[nextBatch](size_t(256));
+        auto &elements = batch.get<const std::vector<int> &>();
+        if (elements.empty()) break;
+        for (auto element : elements) benchmark::DoNotOptimize(element);
+      }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+  }
+
+  void arrayColumnGather(benchmark::State &state) {
+    auto elementClass = createAClass();
+    auto arrayClass = createArrayClass<std::vector<A>>();
+    addColumnMethods(arrayClass, elementClass.data);
+    auto array = arrayClass.construct();
+    array["resize"](size_t(state.range(0)));
+    Key getColumn = "getColumn";
+    allocations::Reporter reporter(state);
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(array[getColumn]("value"));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+  }
+
+}  // namespace
+
+BENCHMARK(instanceMethodCall);
+BENCHMARK(staticInstanceMethodCall);
+BENCHMARK(inheritedMethodCall);
+BENCHMARK(frozenInheritedMethodCall);
+BENCHMARK(boundMethodCall);
+BENCHMARK(typedMethodCall);
+BENCHMARK(inlineMethodCall);
+BENCHMARK(nativeMethodCall);
+BENCHMARK(memberGetterRead);
+BENCHMARK(fieldRead);
+BENCHMARK(batchedMethodCall)->Range(8, 4096);
+BENCHMARK(classConstruct);
+BENCHMARK(classCreate);
+BENCHMARK(staticClassCreate);
+BENCHMARK(arrayElementAccess)->Range(8, 4096);
+BENCHMARK(arrayBufferAccess)->Range(8, 4096);
+BENCHMARK(arrayBatchIteration)->Range(8, 4096);
+BENCHMARK(arrayColumnGather)->Range(8, 4096);
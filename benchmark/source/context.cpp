@@ -0,0 +1,164 @@
+#include <benchmark/benchmark.h>
+#include <glue/class.h>
+#include <glue/context.h>
+#include <glue/declarations.h>
+#include <glue/lazy_map.h>
+
+#include <memory_resource>
+#include <sstream>
+#include <string>
+
+#include "allocations.h"
+
+using namespace glue;
+
+namespace {
+
+  struct A {
+    int value = 0;
+    int add(int x) const { return value + x; }
+  };
+
+  /**
+   * Creates a tree of `modules` maps with `classes` class maps each.
+   * If given, all maps are allocated from `resource`.
+   */
+  MapValue createTree(size_t modules, size_t classes,
+                      std::pmr::memory_resource *resource = nullptr) {
+    auto createMap = [&]() { return resource ? createAnyMap(resource) : createAnyMap(); };
+    auto root = createMap();
+    for (size_t m = 0; m < modules; ++m) {
+      auto module = createMap();
+      for (size_t c = 0; c < classes; ++c) {
+        module["C" + std::to_string(c)] = createClass<A>(WithBases<>(), createMap())
+                                               .addConstructor<>()
+                                               .addMethod("add", &A::add)
+                                               .addMember("value", &A::value);
+        module["f" + std::to_string(c)] = [](int x) { return x; };
+      }
+      root["M" + std::to_string(m)] = module;
+    }
+    return root;
+  }
+
+  /**
+   * Same as `createTree`, but registers the classes as lazy factories.
+   */
+  MapValue createLazyTree(size_t modules, size_t classes) {
+    auto root = createAnyMap();
+    for (size_t m = 0; m < modules; ++m) {
+      auto module = std::make_shared<LazyMap>();
+      for (size_t c = 0; c < classes; ++c) {
+        module->setFactory("C" + std::to_string(c), []() {
+          return createClass<A>()
+              .addConstructor<>()
+              .addMethod("add", &A::add)
+              .addMember("value", &A::value);
+        });
+        module->setFactory("f" + std::to_string(c), []() { return [](int x) { return x; }; });
+      }
+      root["M" + std::to_string(m)] = MapValue(module);
+    }
+    return root;
+  }
+
+  void treeCreate(benchmark::State &state) {
+    auto size = size_t(state.range(0));
+    allocations::Reporter reporter(state);
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(createTree(size, size));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(0));
+  }
+
+  void arenaTreeCreate(benchmark::State &state) {
+    auto size = size_t(state.range(0));
+    allocations::Reporter reporter(state);
+    for (auto _ : state) {
+      std::pmr::monotonic_buffer_resource arena;
+      benchmark::DoNotOptimize(createTree(size, size, &arena));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(0));
+  }
+
+  void lazyTreeCreate(benchmark::State &state) {
+    auto size = size_t(state.range(0));
+    allocations::Reporter reporter(state);
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(createLazyTree(size, size));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(0));
+  }
+
+  void contextAddRootMap(benchmark::State &state) {
+    auto size = size_t(state.range(0));
+    auto root = createTree(size, size);
+    allocations::Reporter reporter(state);
+    for (auto _ : state) {
+      Context context;
+      context.addRootMap(root);
+      benchmark::DoNotOptimize(context);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(0));
+  }
+
+  void contextCreateInstance(benchmark::State &state) {
+    auto root = createTree(size_t(state.range(0)), size_t(state.range(0)));
+    Context context;
+    context.addRootMap(root);
+    Value value = A();
+    allocations::Reporter reporter(state);
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(context.createInstance(value));
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  void declarationPrint(benchmark::State &state, size_t threads) {
+    auto size = size_t(state.range(0));
+    auto root = createTree(size, size);
+    Context context;
+    context.addRootMap(root);
+    DeclarationPrinter printer;
+    printer.init();
+    printer.threads = threads;
+    size_t bytes = 0;
+    allocations::Reporter reporter(state);
+    for (auto _ : state) {
+      std::ostringstream stream;
+      printer.print(stream, root, &context);
+      bytes += stream.str().size();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(0));
+    state.SetBytesProcessed(int64_t(bytes));
+  }
+
+  void declarationPrintCached(benchmark::State &state) {
+    auto size = size_t(state.range(0));
+    auto root = createTree(size, size);
+    Context context;
+    context.addRootMap(root);
+    DeclarationPrinter printer;
+    printer.init();
+    DeclarationCache cache;
+    std::ostringstream initial;
+    printer.print(initial, root, &context, cache);
+    allocations::Reporter reporter(state);
+    for (auto _ : state) {
+      std::ostringstream stream;
+      printer.print(stream, root, &context, cache);
+      benchmark::DoNotOptimize(stream);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(0));
+  }
+
+}  // namespace
+
+BENCHMARK(treeCreate)->RangeMultiplier(4)->Range(4, 64);
+BENCHMARK(arenaTreeCreate)->RangeMultiplier(4)->Range(4, 64);
+BENCHMARK(lazyTreeCreate)->RangeMultiplier(4)->Range(4, 64);
+BENCHMARK(contextAddRootMap)->RangeMultiplier(4)->Range(4, 64);
+BENCHMARK(contextCreateInstance)->RangeMultiplier(4)->Range(4, 64);
+BENCHMARK_CAPTURE(declarationPrint, serial, 1)->RangeMultiplier(4)->Range(4, 64);
+BENCHMARK_CAPTURE(declarationPrint, parallel, 4)->RangeMultiplier(4)->Range(4, 64);
+BENCHMARK(declarationPrintCached)->RangeMultiplier(4)->Range(4, 64);
@@ -0,0 +1,4 @@
+#include <benchmark/benchmark.h>
+
+// Run with `--benchmark_format=json` or `--benchmark_out=<file>` for machine-readable results.
+BENCHMARK_MAIN();
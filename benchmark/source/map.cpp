@@ -0,0 +1,103 @@
+#include <benchmark/benchmark.h>
+#include <glue/anymap.h>
+#include <glue/flat_anymap.h>
+#include <glue/frozen_map.h>
+#include <glue/value.h>
+
+#include <string>
+#include <vector>
+
+#include "allocations.h"
+
+using namespace glue;
+
+namespace {
+
+  std::vector<Key> createKeys(size_t count) {
+    std::vector<Key> keys;
+    for (size_t i = 0; i < count; ++i) {
+      keys.emplace_back("key" + std::to_string(i));
+    }
+    return keys;
+  }
+
+  template <class M> void mapGet(benchmark::State &state) {
+    auto keys = createKeys(size_t(state.range(0)));
+    M map;
+    for (size_t i = 0; i < keys.size(); ++i) {
+      map.set(keys[i], int(i));
+    }
+    size_t i = 0;
+    allocations::Reporter reporter(state);
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(map.get(keys[i++ % keys.size()]));
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  template <class M> void mapSet(benchmark::State &state) {
+    auto keys = createKeys(size_t(state.range(0)));
+    M map;
+    Any value = 42;
+    size_t i = 0;
+    allocations::Reporter reporter(state);
+    for (auto _ : state) {
+      map.set(keys[i++ % keys.size()], value);
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  void frozenMapGet(benchmark::State &state) {
+    auto keys = createKeys(size_t(state.range(0)));
+    auto source = createAnyMap();
+    for (size_t i = 0; i < keys.size(); ++i) {
+      source[keys[i]] = int(i);
+    }
+    auto map = createFrozenMap(source);
+    size_t i = 0;
+    allocations::Reporter reporter(state);
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(map.data->get(keys[i++ % keys.size()]));
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  void mapGetWithStringKey(benchmark::State &state) {
+    AnyMap map;
+    map.set("value", 42);
+    std::string key = "value";
+    allocations::Reporter reporter(state);
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(map.get(key));
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  /**
+   * Looks up a key defined at the end of a chain of `range(0)` extended maps.
+   */
+  void extendsChainGet(benchmark::State &state) {
+    Key key = "value";
+    auto map = createAnyMap();
+    map[key] = 42;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+      auto derived = createAnyMap();
+      derived.setExtends(map);
+      map = derived;
+    }
+    allocations::Reporter reporter(state);
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(map.get(key));
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(mapGet, AnyMap)->RangeMultiplier(4)->Range(4, 4096);
+BENCHMARK_TEMPLATE(mapGet, FlatAnyMap)->RangeMultiplier(4)->Range(4, 4096);
+BENCHMARK(frozenMapGet)->RangeMultiplier(4)->Range(4, 4096);
+BENCHMARK_TEMPLATE(mapSet, AnyMap)->RangeMultiplier(4)->Range(4, 4096);
+BENCHMARK_TEMPLATE(mapSet, FlatAnyMap)->RangeMultiplier(4)->Range(4, 4096);
+BENCHMARK(mapGetWithStringKey);
+BENCHMARK(extendsChainGet)->DenseRange(0, 8, 2);
@@ -3,15 +3,29 @@
 #include <glue/map.h>
 #include <glue/value.h>
 
+#include <memory_resource>
 #include <unordered_map>
 
 namespace glue {
 
   struct AnyMap : public Map {
-    std::unordered_map<std::string, Any> data;
-    Any get(const std::string &key) const;
-    void set(const std::string &key, const Any &value);
+    /**
+     * Note: modifying the data directly bypasses version tracking, use `set` instead.
+     */
+    std::pmr::unordered_map<Key, Any> data;
+    uint64_t currentVersion = 1;
+
+    AnyMap() = default;
+
+    /**
+     * Allocates the map's nodes from `resource`. The stored values are boxed independently.
+     */
+    explicit AnyMap(std::pmr::memory_resource *resource) : data(resource) {}
+
+    Any get(const Key &key) const;
+    void set(const Key &key, const Any &value);
     bool forEach(const std::function<bool(const std::string &)> &callback) const;
+    uint64_t version() const { return currentVersion; }
   };
 
 }  // namespace glue
\ No newline at end of file
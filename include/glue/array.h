@@ -2,11 +2,173 @@
 
 #include <glue/class.h>
 
+#include <algorithm>
+#include <iterator>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
 namespace glue {
 
+  /**
+   * A view of the contiguous storage of an array, allowing backends to read and write elements
+   * without boxing. Invalidated when the array is resized or destroyed.
+   */
+  struct ArrayBuffer {
+    void *data = nullptr;
+    size_t size = 0;
+    size_t elementSize = 0;
+    TypeID elementType;
+
+    /**
+     * Returns the typed data or `nullptr` if the elements are not of type `T`.
+     */
+    template <class T> T *as() const {
+      return elementType == getTypeID<T>() ? static_cast<T *>(data) : nullptr;
+    }
+  };
+
+  namespace detail {
+
+    template <class Array, class = void> struct HasContiguousStorage : std::false_type {};
+
+    template <class Array>
+    struct HasContiguousStorage<Array, std::void_t<decltype(std::declval<Array &>().data())>>
+        : std::negation<std::is_same<typename Array::value_type, bool>> {};
+
+    template <class Array, class = void> struct HasReserve : std::false_type {};
+
+    template <class Array>
+    struct HasReserve<Array, std::void_t<decltype(std::declval<Array &>().reserve(size_t()))>>
+        : std::true_type {};
+
+    template <class Container> struct HasRandomAccess
+        : std::is_base_of<std::random_access_iterator_tag,
+                          typename std::iterator_traits<
+                              typename Container::const_iterator>::iterator_category> {};
+
+    /**
+     * Returns the field `name` of the elements of type `V`, described by `elementClass`.
+     */
+    template <class V> std::pair<std::shared_ptr<const FieldTable>, const FieldDescriptor *>
+    getElementField(const MapValue &elementClass, std::string_view name) {
+      auto table = getFieldTable(elementClass);
+      if (!table || table->type != getTypeID<V>()) {
+        throw std::runtime_error("element class has no fields");
+      }
+      // names come from scripts, so they are not interned
+      auto key = Key::find(name);
+      auto field = key ? table->find(*key) : nullptr;
+      if (!field) {
+        throw std::runtime_error("unknown field " + std::string(name));
+      }
+      return std::make_pair(std::move(table), field);
+    }
+
+    inline void checkArrayRange(size_t start, size_t count, size_t size) {
+      if (start > size || count > size - start) {
+        throw std::runtime_error("invalid array range");
+      }
+    }
+
+  }  // namespace detail
+
+  /**
+   * A forward cursor over a random access container, handing out elements one by one or in
+   * batches. The cursor shares ownership of the container and refers to its position by index,
+   * so it stays valid if the container is modified and ends early if it shrinks.
+   */
+  template <class Container> struct Cursor {
+    static_assert(detail::HasRandomAccess<Container>::value,
+                  "cursors require random access containers");
+    using Value = typename Container::value_type;
+
+    std::shared_ptr<const Container> container;
+    size_t index = 0;
+
+    bool done() const { return !container || index >= container->size(); }
+
+    Value next() {
+      if (done()) throw std::runtime_error("cursor is exhausted");
+      return *(container->begin() + index++);
+    }
+
+    /**
+     * Returns up to `count` elements, an empty batch marks the end.
+     */
+    std::vector<Value> nextBatch(size_t count) {
+      std::vector<Value> batch;
+      if (done()) return batch;
+      count = std::min(count, container->size() - index);
+      auto it = container->begin() + index;
+      batch.reserve(count);
+      for (size_t i = 0; i < count; ++i) batch.push_back(*it++);
+      index += count;
+      return batch;
+    }
+  };
+
+  /**
+   * Creates the class of cursors returned by the `cursor` method of container classes.
+   * It must be registered for scripts to iterate them.
+   */
+  template <class Container> auto createCursorClass() {
+    using C = Cursor<Container>;
+    return glue::createClass<C>()
+        .addMethod("done", &C::done)
+        .addMethod("next", &C::next)
+        .addMethod("nextBatch", &C::nextBatch);
+  }
+
+  /**
+   * Adds methods to iterate a container without a lookup and call per element: `forEach` calls a
+   * function with every element and, for random access containers, `cursor` returns a `Cursor`.
+   */
+  template <class Container> void addIterationMethods(ClassGenerator<Container> &generator) {
+    generator.addMethod("forEach", [](const Container &c, const AnyFunction &callback) {
+      for (auto &&value : c) callback(detail::convertArgumentToAny(value));
+    });
+    if constexpr (detail::HasRandomAccess<Container>::value) {
+      generator.addMethod("cursor", [](const Any &self) {
+        std::shared_ptr<const Container> container = self.getShared<Container>();
+        if (!container) container = self.getShared<const Container>();
+        if (!container) throw std::runtime_error("invalid receiver");
+        return Cursor<Container>{std::move(container)};
+      });
+    }
+  }
+
+  /**
+   * Adds methods to a contiguous array class copying a field of all elements into a
+   * `std::vector` of the field type with `getColumn` and back with `setColumn`.
+   * Fields are taken from the field table of `elementClass`, see `FieldTable`.
+   */
+  template <class Array>
+  void addColumnMethods(ClassGenerator<Array> &generator, const MapValue &elementClass) {
+    static_assert(detail::HasContiguousStorage<Array>::value, "array must be contiguous");
+    using V = typename Array::value_type;
+    generator
+        .addMethod("getColumn",
+                   [elementClass](const Array &arr, const std::string &name) {
+                     auto field = detail::getElementField<V>(elementClass, name).second;
+                     return field->gather(*field, arr.data(), sizeof(V), arr.size());
+                   })
+        .addMethod("setColumn", [elementClass](Array &arr, const std::string &name,
+                                               const Any &column) {
+          auto field = detail::getElementField<V>(elementClass, name).second;
+          field->scatter(*field, arr.data(), sizeof(V), arr.size(), column);
+        });
+  }
+
+  /**
+   * Creates a class for a sequence container.
+   * Besides element-wise access, ranges can be copied with `getRange`, `setRange` and `append`.
+   * Contiguous arrays provide an `ArrayBuffer` of their storage through `buffer`.
+   * Arrays are iterable through `addIterationMethods`.
+   */
   template <class Array, class V = typename Array::value_type> auto createArrayClass() {
-    return glue::createClass<Array>()
-        .addConstructor()
+    auto generator = glue::createClass<Array>();
+    generator.addConstructor()
         .addMethod("push", [](Array &arr, V v) { arr.emplace_back(std::move(v)); })
         .addMethod("size", [](const Array &arr) { return arr.size(); })
         .addMethod("pop",
@@ -38,8 +200,47 @@ namespace glue {
                      if (arr.size() < idx) throw std::runtime_error("invalid array insert index");
                      arr.insert(arr.begin() + idx, std::move(v));
                    })
-        .addMethod("clear", [](Array &arr) { arr.clear(); });
-    ;
+        .addMethod("clear", [](Array &arr) { arr.clear(); })
+        .addMethod("getRange",
+                   [](const Array &arr, size_t start, size_t count) {
+                     detail::checkArrayRange(start, count, arr.size());
+                     return Array(arr.begin() + start, arr.begin() + start + count);
+                   })
+        .addMethod("setRange",
+                   [](Array &arr, size_t start, const Array &values) {
+                     detail::checkArrayRange(start, values.size(), arr.size());
+                     // an array set to itself is unchanged
+                     if (&values == &arr) return;
+                     std::copy(values.begin(), values.end(), arr.begin() + start);
+                   })
+        .addMethod("append",
+                   [](Array &arr, const Array &values) {
+                     if (&values == &arr) {
+                       // inserting elements of the array itself would read invalidated elements
+                       Array copy(values);
+                       arr.insert(arr.end(), copy.begin(), copy.end());
+                     } else {
+                       arr.insert(arr.end(), values.begin(), values.end());
+                     }
+                   });
+    if constexpr (std::is_default_constructible<V>::value) {
+      generator.addMethod("resize", [](Array &arr, size_t size) { arr.resize(size); });
+    }
+    addIterationMethods(generator);
+    if constexpr (detail::HasReserve<Array>::value) {
+      generator.addMethod("reserve", [](Array &arr, size_t size) { arr.reserve(size); });
+    }
+    if constexpr (detail::HasContiguousStorage<Array>::value) {
+      generator.addMethod("buffer", [](Array &arr) {
+        ArrayBuffer buffer;
+        buffer.data = arr.data();
+        buffer.size = arr.size();
+        buffer.elementSize = sizeof(V);
+        buffer.elementType = getTypeID<V>();
+        return buffer;
+      });
+    }
+    return generator;
   }
 
 }  // namespace glue
\ No newline at end of file
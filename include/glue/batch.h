@@ -0,0 +1,49 @@
+#pragma once
+
+#include <glue/instance.h>
+
+#include <vector>
+
+namespace glue {
+
+  struct InvokeOptions {
+    /**
+     * The number of threads to distribute the calls over, `1` calls on the current thread.
+     * Methods called on multiple threads must be thread-safe.
+     */
+    size_t threads = 1;
+
+    /**
+     * The minimum number of instances handled by a thread
+     */
+    size_t minChunkSize = 1024;
+  };
+
+  /**
+   * Calls the method `key` on `count` instances with the same arguments.
+   * The method is resolved once per class map on the calling thread and the arguments are only
+   * boxed once. If `results` is not `nullptr`, it receives the result of each call.
+   * All calls share the boxed arguments, so the method must take them by value or const
+   * reference. Modifying an argument through a non-const reference changes it for the following
+   * calls and is a data race when the calls are distributed over multiple threads.
+   */
+  void invokeAll(const Instance *instances, size_t count, const Key &key,
+                 const AnyArguments &arguments, Any *results,
+                 const InvokeOptions &options = InvokeOptions());
+
+  /**
+   * Calls the method `key` on all instances with the given arguments and returns the results.
+   * The arguments are shared by all calls, so the method must take them by value or const
+   * reference.
+   */
+  template <typename... Args>
+  std::vector<Any> invokeAll(const std::vector<Instance> &instances, const Key &key,
+                             Args &&...args) {
+    std::vector<Any> results(instances.size());
+    invokeAll(instances.data(), instances.size(), key,
+              AnyArguments{detail::convertArgumentToAny(std::forward<Args>(args))...},
+              results.data());
+    return results;
+  }
+
+}  // namespace glue
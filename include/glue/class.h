@@ -1,6 +1,9 @@
 #pragma once
 
 #include <glue/detail/reference_visitable.h>
+#include <glue/detail/typed_method.h>
+#include <glue/fields.h>
+#include <glue/frozen_map.h>
 #include <glue/instance.h>
 #include <glue/keys.h>
 #include <glue/value.h>
@@ -27,12 +30,33 @@ namespace glue {
     std::function<Any(Any)> converter;
   };
 
-  template <class T> ClassInfo createClassInfo() {
+  template <typename... args> struct WithBases {};
+
+  template <class T, class... Bases> ClassInfo createClassInfo(WithBases<Bases...> = {}) {
     ClassInfo result;
     result.typeID = getTypeID<T>();
     result.constTypeID = getTypeID<const T>();
     result.sharedTypeID = getTypeID<std::shared_ptr<T>>();
     result.sharedConstTypeID = getTypeID<std::shared_ptr<const T>>();
+    if constexpr (sizeof...(Bases) > 0) {
+      result.converter = [](Any value) {
+        if (auto t = value.getShared<T>()) {
+          using namespace revisited;
+          using VisitableType = typename detail::SharedReferenceVisitable<T, TypeList<Bases...>,
+                                                                          TypeList<>, T>::type;
+          // keep the original pointer alive and capture a reference to T
+          value.set<VisitableType>(std::move(t));
+        } else if (auto ts = value.getShared<const T>()) {
+          using namespace revisited;
+          using VisitableType =
+              typename detail::SharedReferenceVisitable<const T, TypeList<Bases...>, TypeList<>,
+                                                        const T>::type;
+          // keep the original pointer alive and capture a reference to T
+          value.set<VisitableType>(std::move(ts));
+        }
+        return value;
+      };
+    }
     return result;
   }
 
@@ -44,59 +68,84 @@ namespace glue {
     return value[keys::classKey]->getShared<ClassInfo>();
   }
 
-  template <typename... args> struct WithBases {};
+  namespace detail {
 
-  template <class T> struct ClassGenerator : public ValueBase {
-    MapValue data = createAnyMap();
-
-    template <class... Bases> ClassGenerator(WithBases<Bases...>) {
-      auto classInfo = createClassInfo<T>();
-      if constexpr (sizeof...(Bases) > 0) {
-        classInfo.converter = [](Any value) {
-          if (auto t = value.getShared<T>()) {
-            using namespace revisited;
-            using VisitableType = typename detail::SharedReferenceVisitable<T, TypeList<Bases...>,
-                                                                            TypeList<>, T>::type;
-            // keep the original pointer alive and capture a reference to T
-            value.set<VisitableType>(std::move(t));
-          } else if (auto ts = value.getShared<const T>()) {
-            using namespace revisited;
-            using VisitableType =
-                typename detail::SharedReferenceVisitable<const T, TypeList<Bases...>, TypeList<>,
-                                                          const T>::type;
-            // keep the original pointer alive and capture a reference to T
-            value.set<VisitableType>(std::move(ts));
-          }
-          return value;
-        };
+    /**
+     * Returns a shared pointer to the object selected by `select` from the receiver, sharing
+     * ownership with it. Selects through a const reference if the receiver is const.
+     */
+    template <class T, class F> Any aliasReceiver(const Any &self, F &&select) {
+      if (auto owner = self.getShared<T>()) {
+        auto ptr = select(*owner);
+        return std::shared_ptr<std::remove_pointer_t<decltype(ptr)>>(owner, ptr);
+      } else if (auto constOwner = self.getShared<const T>()) {
+        auto ptr = select(*constOwner);
+        return std::shared_ptr<std::remove_pointer_t<decltype(ptr)>>(constOwner, ptr);
       }
-      data[keys::classKey] = classInfo;
+      throw std::runtime_error("invalid receiver");
+    }
+
+  }  // namespace detail
+
+  template <class T> struct ClassGenerator : public ValueBase {
+    MapValue data;
+
+    /**
+     * Methods callable without boxing through `Instance::call`
+     */
+    std::shared_ptr<detail::TypedMethodTable> typedMethods
+        = std::make_shared<detail::TypedMethodTable>();
+
+    /**
+     * Offsets of trivially copyable members, created when the first one is added
+     */
+    std::shared_ptr<FieldTable> fields;
+
+    /**
+     * @param map the map that will store the class data, e.g. `createFlatMap()`, or
+     * `createFlatMap(resource)` to allocate the map storage from a memory resource
+     */
+    template <class... Bases>
+    ClassGenerator(WithBases<Bases...>, MapValue map = createAnyMap()) : data(std::move(map)) {
+      data[keys::classKey] = createClassInfo<T>(WithBases<Bases...>());
+      data[keys::typedMethodsKey] = typedMethods;
+    }
+
+    /**
+     * Adds a method that is also registered in the typed method table, if its signature allows.
+     */
+    template <class F> void setMethod(const Key &name, F f) {
+      auto typedMethod = detail::createTypedMethod<T>(f);
+      data[name] = AnyFunction(std::move(f));
+      if (typedMethod) typedMethod->setSource(*data.rawGet(name));
+      typedMethods->methods[name] = std::move(typedMethod);
+      if (fields) fields->erase(name);
     }
 
     template <class B, class R, typename... Args>
-    ClassGenerator &addNonConstMethod(const std::string &name, R (B::*f)(Args...)) {
+    ClassGenerator &addNonConstMethod(const Key &name, R (B::*f)(Args...)) {
       static_assert(std::is_base_of<B, T>::value);
-      data[name]
-          = [f](T &o, Args... args) { return std::invoke(f, o, std::forward<Args>(args)...); };
+      setMethod(name,
+                [f](T &o, Args... args) { return std::invoke(f, o, std::forward<Args>(args)...); });
       return *this;
     }
 
     template <class B, class R, typename... Args>
-    ClassGenerator &addConstMethod(const std::string &name, R (B::*f)(Args...) const) {
+    ClassGenerator &addConstMethod(const Key &name, R (B::*f)(Args...) const) {
       static_assert(std::is_base_of<B, T>::value);
-      data[name] = [f](const T &o, Args... args) {
+      setMethod(name, [f](const T &o, Args... args) {
         return std::invoke(f, o, std::forward<Args>(args)...);
-      };
+      });
       return *this;
     }
 
     template <class B, class R, typename... Args>
-    ClassGenerator &addMethod(const std::string &name, R (B::*f)(Args...)) {
+    ClassGenerator &addMethod(const Key &name, R (B::*f)(Args...)) {
       return addNonConstMethod(name, f);
     }
 
     template <class B, class R, typename... Args>
-    ClassGenerator &addMethod(const std::string &name, R (B::*f)(Args...) const) {
+    ClassGenerator &addMethod(const Key &name, R (B::*f)(Args...) const) {
       return addConstMethod(name, f);
     }
 
@@ -105,25 +154,67 @@ namespace glue {
       return *this;
     }
 
-    template <class O> ClassGenerator &addConstMember(const std::string &name, O T::*ptr) {
-      data[name] = [ptr](const T &o) { return o.*ptr; };
+    template <class O> ClassGenerator &addConstMember(const Key &name, O T::*ptr) {
+      setMethod(name, [ptr](const T &o) { return o.*ptr; });
+      addField(name, ptr, true);
       return *this;
     }
 
-    template <class O> ClassGenerator &addMember(const std::string &name, O T::*ptr) {
+    template <class O> ClassGenerator &addMember(const Key &name, O T::*ptr) {
       addConstMember(name, ptr);
-      std::string setName = "set" + name;
-      setName[3] = char(toupper(setName[3]));
       if constexpr (std::is_fundamental<O>::value) {
-        data[setName] = [ptr](T &o, O v) { o.*ptr = std::move(v); };
+        setMethod(setterName(name), [ptr](T &o, O v) { o.*ptr = std::move(v); });
       } else {
-        data[setName] = [ptr](T &o, const O &v) { o.*ptr = v; };
+        setMethod(setterName(name), [ptr](T &o, const O &v) { o.*ptr = v; });
       }
+      addField(name, ptr, false);
+      return *this;
+    }
+
+    /**
+     * Adds a member whose getter returns a shared pointer aliasing the member instead of a
+     * copy, keeping the instance alive. The pointer is const if the instance is const.
+     * The setter takes its argument by value and moves it into the member.
+     * The getter takes the instance as `Any` to share its ownership, which declarations and
+     * schemas treat as the receiver of a method.
+     */
+    template <class O> ClassGenerator &addMemberRef(const Key &name, O T::*ptr) {
+      setMethod(name, [ptr](const Any &self) -> Any {
+        return detail::aliasReceiver<T>(self, [ptr](auto &o) { return &(o.*ptr); });
+      });
+      setMethod(setterName(name), [ptr](T &o, O v) { o.*ptr = std::move(v); });
+      addField(name, ptr, false);
+      return *this;
+    }
+
+    /**
+     * Adds a method returning a reference into the instance, which is returned as a shared
+     * pointer aliasing the result that keeps the instance alive.
+     */
+    template <class B, class R, typename... Args>
+    ClassGenerator &addMethodRef(const Key &name, R &(B::*f)(Args...) const) {
+      static_assert(std::is_base_of<B, T>::value);
+      setMethod(name, [f](const Any &self, Args... args) -> Any {
+        return detail::aliasReceiver<T>(self, [&](const T &o) {
+          return &std::invoke(f, o, std::forward<Args>(args)...);
+        });
+      });
+      return *this;
+    }
+
+    template <class B, class R, typename... Args>
+    ClassGenerator &addMethodRef(const Key &name, R &(B::*f)(Args...)) {
+      static_assert(std::is_base_of<B, T>::value);
+      setMethod(name, [f](const Any &self, Args... args) -> Any {
+        auto owner = self.getShared<T>();
+        if (!owner) throw std::runtime_error("invalid receiver");
+        return std::shared_ptr<R>(owner, &std::invoke(f, *owner, std::forward<Args>(args)...));
+      });
       return *this;
     }
 
-    template <class F> ClassGenerator &addMethod(const std::string &name, F f) {
-      data[name] = AnyFunction(f);
+    template <class F> ClassGenerator &addMethod(const Key &name, F f) {
+      setMethod(name, std::move(f));
       return *this;
     }
 
@@ -131,11 +222,27 @@ namespace glue {
     typename std::enable_if<std::is_base_of<ValueBase, O>::value, ClassGenerator &>::type
     setExtends(const O &base) {
       data[keys::extendsKey] = base.data;
+      if (auto baseMap = Value(base.data).asMap()) {
+        typedMethods->base = baseMap.rawGet(keys::typedMethodsKey)
+                                 ->template getShared<detail::TypedMethodTable>();
+      }
       return *this;
     }
 
-    template <class O> ClassGenerator &addValue(const std::string &key, O &&value) {
+    template <class O> ClassGenerator &addValue(const Key &key, O &&value) {
       data[key] = std::forward<O>(value);
+      typedMethods->methods[key] = nullptr;
+      if (fields) fields->erase(key);
+      return *this;
+    }
+
+    /**
+     * Replaces the class data by an immutable perfect-hash table that can be shared across
+     * threads. The class can't be modified afterwards and its base classes should be complete
+     * and must not be modified while other threads use the class.
+     */
+    ClassGenerator &freeze() {
+      data = createFrozenMap(data);
       return *this;
     }
 
@@ -149,10 +256,37 @@ namespace glue {
       }
       return Instance(data, value);
     }
+
+  private:
+    /**
+     * Records the member's offset if it can be accessed directly.
+     */
+    template <class O> void addField(const Key &name, O T::*ptr, bool readOnly) {
+      if constexpr (std::is_standard_layout<T>::value && detail::IsFieldType<O>::value) {
+        if (!fields) {
+          fields = std::make_shared<FieldTable>();
+          fields->type = getTypeID<T>();
+          fields->getConstObject = detail::getConstObject<T>;
+          fields->getObject = detail::getObject<T>;
+          data[keys::fieldsKey] = fields;
+        }
+        fields->erase(name);
+        auto field = detail::createFieldDescriptor(name, ptr);
+        field.readOnly = readOnly;
+        fields->fields.push_back(field);
+      }
+    }
+
+    static std::string setterName(const Key &name) {
+      std::string result = "set" + name.str();
+      result[3] = char(toupper(result[3]));
+      return result;
+    }
   };
 
-  template <class T, class... B> auto createClass(WithBases<B...> bases = WithBases<>()) {
-    return ClassGenerator<T>(bases);
+  template <class T, class... B>
+  auto createClass(WithBases<B...> bases = WithBases<>(), MapValue map = createAnyMap()) {
+    return ClassGenerator<T>(bases, std::move(map));
   }
 
 }  // namespace glue
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <glue/map.h>
+#include <glue/value.h>
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+namespace glue {
+
+  /**
+   * A thread-safe map with wait-free readers.
+   * Readers access an immutable snapshot of the data, protected by a reader count. `set` is
+   * serialized, copies the current snapshot, publishes the modified copy and waits for readers
+   * of the previous snapshot before releasing it. Writes are therefore O(n) and best suited for
+   * maps that are read far more often than written.
+   *
+   * `forEach` callbacks must not modify the map they are iterating.
+   *
+   * The map does not track versions, so `MapValue::get` never caches lookups through it.
+   * `MapValue::get` may be called concurrently as long as all maps along the extends chain are
+   * safe to read concurrently, such as `ConcurrentAnyMap` or `FrozenMap`.
+   */
+  class ConcurrentAnyMap : public Map {
+  public:
+    ConcurrentAnyMap();
+    ConcurrentAnyMap(const ConcurrentAnyMap &) = delete;
+    ConcurrentAnyMap &operator=(const ConcurrentAnyMap &) = delete;
+    ~ConcurrentAnyMap();
+
+    Any get(const Key &key) const;
+    void set(const Key &key, const Any &value);
+    bool forEach(const std::function<bool(const std::string &)> &callback) const;
+
+    size_t size() const;
+
+  private:
+    using Data = std::unordered_map<Key, Any>;
+
+    class ReadGuard;
+
+    std::atomic<const Data *> current;
+    std::atomic<size_t> epoch{0};
+    mutable std::atomic<size_t> readers[2];
+    std::mutex writeMutex;
+
+    void waitForReaders(size_t parity) const;
+  };
+
+}  // namespace glue
@@ -5,7 +5,14 @@
 #include <glue/map.h>
 #include <glue/value.h>
 
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <map>
+#include <mutex>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace glue {
@@ -20,14 +27,210 @@ namespace glue {
       std::shared_ptr<const ClassInfo> classInfo;
     };
 
-    std::unordered_map<TypeIndex, TypeInfo> types;
+    /**
+     * The registered classes, each stored once and indexed by its type, const type and shared
+     * pointer types. Offers the read-only interface of the `std::unordered_map` it replaces, with
+     * one element per indexed type. References are invalidated when classes are added or removed.
+     * Classes that lookups find in `LazyMap` entries are only added by the next modification of
+     * the context, or by `resolveLazyEntries`.
+     */
+    class TypeTable {
+    public:
+      using key_type = TypeIndex;
+      using mapped_type = TypeInfo;
+      using value_type = std::pair<const TypeIndex, const TypeInfo &>;
+
+      class const_iterator {
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = TypeTable::value_type;
+        using difference_type = std::ptrdiff_t;
+        using reference = value_type;
+        struct pointer {
+          value_type value;
+          const value_type *operator->() const { return &value; }
+        };
+
+        reference operator*() const {
+          auto &slot = table->index[position];
+          return value_type(slot.type, table->entries[slot.info - 1]);
+        }
+        pointer operator->() const { return pointer{**this}; }
+        const_iterator &operator++() {
+          ++position;
+          skipEmpty();
+          return *this;
+        }
+        const_iterator operator++(int) {
+          auto result = *this;
+          ++*this;
+          return result;
+        }
+        bool operator==(const const_iterator &other) const { return position == other.position; }
+        bool operator!=(const const_iterator &other) const { return position != other.position; }
+
+      private:
+        friend class TypeTable;
+        const TypeTable *table = nullptr;
+        size_t position = 0;
+
+        const_iterator(const TypeTable *t, size_t p) : table(t), position(p) { skipEmpty(); }
+        void skipEmpty() {
+          while (position < table->index.size() && table->index[position].info == 0) ++position;
+        }
+      };
+      using iterator = const_iterator;
+
+      const_iterator begin() const { return const_iterator(this, 0); }
+      const_iterator end() const { return const_iterator(this, index.size()); }
+      const_iterator find(TypeIndex type) const;
+      size_t count(TypeIndex type) const { return get(type) ? 1 : 0; }
+
+      /**
+       * Returns the class registered for the type, throws `std::out_of_range` if there is none.
+       */
+      const TypeInfo &at(TypeIndex type) const;
+      const TypeInfo &operator[](TypeIndex type) const { return at(type); }
+
+      size_t size() const { return indexSize; }
+      bool empty() const { return indexSize == 0; }
+
+    private:
+      friend class Context;
+
+      /**
+       * The classes, removed classes leave an entry without class info that is reused
+       */
+      std::vector<TypeInfo> entries;
+      std::vector<uint32_t> freeEntries;
+
+      /**
+       * Open-addressing index from the type, const type and shared pointer types of each class
+       * to its position in `entries`, offset by one. Zero marks an empty slot.
+       */
+      struct Slot {
+        TypeIndex type;
+        uint32_t info;
+      };
+      std::vector<Slot> index;
+      size_t indexSize = 0;
+
+      const TypeInfo *get(TypeIndex type) const;
+      size_t slotOf(TypeIndex type) const;
+      uint32_t positionOf(const TypeInfo *info) const { return uint32_t(info - entries.data()); }
+      uint32_t insert(TypeInfo typeInfo);
+      void erase(uint32_t position);
+      void insertIndex(TypeIndex type, uint32_t info);
+      void eraseIndex(TypeIndex type);
+      void rebuildIndex(size_t capacity);
+    };
+
+    TypeTable types;
     std::vector<TypeID> uniqueTypes;
 
+    Context() = default;
+    Context(const Context &other);
+    Context &operator=(const Context &other);
+
+    /**
+     * Returns the registered class of the type. Lookups are thread-safe. Classes inside
+     * unmaterialized `LazyMap` entries are found by materializing the pending entries that may
+     * create them under a lock, skipping entries whose factories are known to create other
+     * classes. Classes found this way don't replace registered ones.
+     */
     const TypeInfo *getTypeInfo(TypeIndex type) const;
+
+    /**
+     * Registers the classes of all pending `LazyMap` entries, materializing them, and adds the
+     * classes found by earlier lookups to `types` and `uniqueTypes`.
+     */
+    void resolveLazyEntries();
+
     void addRootMap(const MapValue &map);
     void addMap(const MapValue &map, std::vector<std::string> &path);
 
+    /**
+     * Registers the classes of a module located at `path`, replacing a previously added module
+     * at the same path. Only the module's own subtree is visited.
+     */
+    void addModule(const Path &path, const MapValue &map);
+
+    /**
+     * Removes the classes registered by `addModule` at `path`. Classes that are also registered by
+     * another module or a root map stay available through that registration. Only the module's
+     * classes are visited. Returns `false` if no such module exists.
+     */
+    bool removeModule(const Path &path);
+
     Instance createInstance(Value value) const;
+
+  private:
+    /**
+     * The types of the classes registered by each module
+     */
+    std::map<Path, std::vector<TypeIndex>> modules;
+
+    /**
+     * The registrations of a class, owned by a module or by root maps
+     */
+    struct Registrations {
+      /**
+       * The key in `modules` of the module owning the active registration, `nullptr` for root
+       * maps
+       */
+      const Path *owner = nullptr;
+      /**
+       * Registrations replaced by the active one, the most recent last
+       */
+      std::vector<std::pair<const Path *, TypeInfo>> shadowed;
+    };
+
+    /**
+     * The registrations of each class, by position in `types`
+     */
+    std::vector<Registrations> registrations;
+
+    /**
+     * An unmaterialized `LazyMap` entry whose classes are registered on demand
+     */
+    struct LazyEntry {
+      std::shared_ptr<Map> map;
+      Key key;
+      Path path;
+      /**
+       * The module containing the entry, `nullptr` for root maps
+       */
+      const Path *module;
+      /**
+       * The class created by the entry, if known without materializing it
+       */
+      const ClassInfo *hint;
+    };
+
+    /**
+     * Pending `LazyMap` entries and the classes that const lookups found in them. Lookups only
+     * modify this state under `mutex`, the classes are moved to `types` by the next modification.
+     */
+    struct LazyTypes {
+      std::mutex mutex;
+      std::vector<LazyEntry> pending;
+      std::deque<std::pair<TypeInfo, const Path *>> resolved;
+      std::unordered_map<TypeIndex, size_t> index;
+    };
+    mutable LazyTypes lazy;
+
+    /**
+     * `true` while `lazy` holds pending entries or resolved classes, only changed by
+     * modifications
+     */
+    bool hasLazyTypes = false;
+
+    const TypeInfo *resolveLazyType(TypeIndex type) const;
+    void addLazyTypes();
+
+    void addMap(const MapValue &map, Path &path, const Path *module);
+    void addType(TypeInfo typeInfo, const Path *owner);
+    bool removeType(TypeIndex type, const Path *owner);
   };
 
-}  // namespace glue
\ No newline at end of file
+}  // namespace glue
@@ -4,10 +4,41 @@
 #include <glue/context.h>
 #include <glue/value.h>
 
+#include <cstdint>
+#include <istream>
 #include <ostream>
 
 namespace glue {
 
+  /**
+   * Printed top-level declarations with the content hashes they were printed from, allowing
+   * `DeclarationPrinter` to only reprint changed entries. Can be stored on disk between runs.
+   */
+  struct DeclarationCache {
+    struct Entry {
+      uint64_t hash = 0;
+      bool needsBreak = true;
+      std::string text;
+    };
+
+    std::unordered_map<std::string, Entry> entries;
+
+    /**
+     * The number of entries printed by the last `print` call instead of taken from the cache
+     */
+    size_t reprinted = 0;
+
+    void save(std::ostream &stream) const;
+
+    /**
+     * Returns `false` and leaves the cache empty if the data is not a valid cache.
+     */
+    bool load(std::istream &stream);
+
+    void saveFile(const std::string &path) const;
+    bool loadFile(const std::string &path);
+  };
+
   struct DeclarationPrinter {
     struct State {
       size_t depth = 0;
@@ -26,6 +57,12 @@ namespace glue {
                                           State &state)>;
     std::unordered_map<std::string, KeyPrinter> keyPrinters;
 
+    /**
+     * The number of threads printing the top-level entries. The output is identical for any
+     * number of threads, but key printers and overridden methods must be thread-safe.
+     */
+    size_t threads = 1;
+
     /**
      * must be called after creating the printer
      */
@@ -47,12 +84,32 @@ namespace glue {
     virtual void printMap(std::ostream &stream, const std::string &name, const MapValue &,
                           State &state) const;
     virtual void printInnerBlock(std::ostream &stream, const MapValue &, State &state) const;
+
+    /**
+     * Prints a single entry of a block.
+     * returns `false` if nothing printed.
+     */
+    virtual bool printEntry(std::ostream &stream, const std::string &name, const Value &,
+                            State &state) const;
     virtual void printClassMap(std::ostream &stream, const std::string &name, const MapValue &,
                                State &state) const;
 
     virtual void print(std::ostream &stream, const MapValue &value,
                        Context *context = nullptr) const;
 
+    /**
+     * Prints the declarations, reusing the cached text of top-level entries whose content hash
+     * is unchanged, and updates the cache.
+     */
+    virtual void print(std::ostream &stream, const MapValue &value, Context *context,
+                       DeclarationCache &cache) const;
+
+    /**
+     * Returns a hash over everything the printed declaration of an entry depends on: keys,
+     * function signatures, class info, extends and the names of all referenced types.
+     */
+    virtual uint64_t hashEntry(const std::string &name, const Value &, State &state) const;
+
     virtual ~DeclarationPrinter() {}
   };
 
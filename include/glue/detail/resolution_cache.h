@@ -0,0 +1,115 @@
+#pragma once
+
+#include <glue/key.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace glue {
+
+  struct Map;
+
+  namespace detail {
+
+    /**
+     * Caches where keys are found along the `extends` chain of a map.
+     * The cache is valid as long as the versions of all maps in the chain are unchanged.
+     * It is updated in place without locks: the chain is guarded by a sequence counter that is
+     * odd while the chain is rebuilt, and every slot is tagged with the sequence it was resolved
+     * in, so slots of earlier chains are ignored. Only positions in the chain are stored, not
+     * values, so cached entries never keep maps alive.
+     */
+    struct ResolutionCache {
+      /**
+       * Chains with more maps are not cached
+       */
+      static constexpr size_t maxDepth = 16;
+
+      /**
+       * The number of key slots, keys that don't fit are resolved without the cache
+       */
+      static constexpr size_t capacity = 512;
+
+      /**
+       * The maximum number of slots probed for a key
+       */
+      static constexpr size_t maxProbes = 16;
+
+      /**
+       * A map in the extends chain and its version
+       */
+      struct Link {
+        std::atomic<const Map *> map{nullptr};
+        std::atomic<uint64_t> version{0};
+      };
+
+      /**
+       * A cached key and its tagged position, see `tag`
+       */
+      struct Slot {
+        std::atomic<const void *> key{nullptr};
+        std::atomic<uint64_t> entry{0};
+      };
+
+      static uint64_t tag(uint64_t sequence, uint32_t position) {
+        return (sequence << 16) | position;
+      }
+
+      /**
+       * Even while the chain is stable, odd while it is rebuilt
+       */
+      std::atomic<uint64_t> sequence{0};
+
+      /**
+       * The number of maps in the chain, starting with the owner. `0` before the first rebuild.
+       */
+      std::atomic<uint32_t> depth{0};
+
+      /**
+       * `false` if the chain contains extends callbacks or maps without version tracking
+       */
+      std::atomic<bool> cacheable{false};
+
+      std::array<Link, maxDepth> chain;
+      std::array<Slot, capacity> slots;
+    };
+
+    /**
+     * Owns the resolution cache of a map, which is created on the first lookup that reaches a
+     * base map and kept for the lifetime of the map. Copies start without a cache.
+     */
+    struct ResolutionCacheHolder {
+      ResolutionCacheHolder() = default;
+      ResolutionCacheHolder(const ResolutionCacheHolder &) {}
+      ResolutionCacheHolder &operator=(const ResolutionCacheHolder &) {
+        delete cache.exchange(nullptr);
+        return *this;
+      }
+      ~ResolutionCacheHolder() { delete cache.load(); }
+
+      /**
+       * Returns the cache, or `nullptr` if it has not been created yet
+       */
+      ResolutionCache *load() const { return cache.load(std::memory_order_acquire); }
+
+      /**
+       * Returns the cache, creating it if necessary
+       */
+      ResolutionCache &create() {
+        auto created = std::make_unique<ResolutionCache>();
+        ResolutionCache *expected = nullptr;
+        if (cache.compare_exchange_strong(expected, created.get(), std::memory_order_acq_rel)) {
+          return *created.release();
+        }
+        return *expected;
+      }
+
+    private:
+      std::atomic<ResolutionCache *> cache{nullptr};
+    };
+
+  }  // namespace detail
+
+}  // namespace glue
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <glue/key.h>
+#include <glue/value.h>
+#include <revisited/any.h>
+#include <revisited/any_function.h>
+
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+namespace glue {
+
+  namespace detail {
+
+    /**
+     * Returns the address of the function stored in the value, which is shared by all copies of
+     * the value, or `nullptr` if it is not a function.
+     */
+    inline const void *functionIdentity(const revisited::Any &value) {
+      if (!value || value.type() != revisited::getTypeID<revisited::AnyFunction>()) {
+        return nullptr;
+      }
+      return &value.get<const revisited::AnyFunction &>();
+    }
+
+    /**
+     * Base for methods callable with their native argument types, bypassing `Any` boxing.
+     */
+    struct TypedMethodBase {
+      /**
+       * The `AnyFunction` stored in the class map that this method was created with and its
+       * address. Used to detect entries that have been replaced without updating the table, the
+       * value is kept so that the address can't be reused by a replacement.
+       */
+      revisited::Any source;
+      const void *sourceIdentity = nullptr;
+
+      void setSource(const revisited::Any &value) {
+        source = value;
+        sourceIdentity = functionIdentity(source);
+      }
+
+      /**
+       * Calls the method with inline arguments and stores the result in `result`.
+       * Returns `false` without calling if the arguments don't convert to the parameter types
+       * without boxing.
+       */
+      virtual bool callInline(const revisited::Any &, const InlineValue *, size_t,
+                              InlineValue &) const {
+        return false;
+      }
+
+      virtual ~TypedMethodBase() {}
+    };
+
+    /**
+     * A method taking the receiver as `Any` and the remaining arguments by const reference.
+     * `R` and `Args` are decayed types, so the signature can be matched by callers.
+     */
+    template <class R, typename... Args> struct TypedMethod : public TypedMethodBase {
+      std::function<R(const revisited::Any &, const Args &...)> function;
+
+      bool callInline(const revisited::Any &self, const InlineValue *arguments, size_t count,
+                      InlineValue &result) const override {
+        if (count != sizeof...(Args)) return false;
+        return callInline(self, arguments, result, std::index_sequence_for<Args...>());
+      }
+
+    private:
+      template <size_t... I>
+      bool callInline(const revisited::Any &self, const InlineValue *arguments,
+                      InlineValue &result, std::index_sequence<I...>) const {
+        if (!(arguments[I].template convertsInline<Args>() && ...)) return false;
+        if constexpr (std::is_void<R>::value) {
+          function(self, arguments[I].template get<Args>()...);
+          result = InlineValue();
+        } else {
+          result = InlineValue(function(self, arguments[I].template get<Args>()...));
+        }
+        (void)arguments;
+        return true;
+      }
+    };
+
+    /**
+     * Typed methods of a class map, keyed by method name.
+     * A `nullptr` entry marks a key that must not be resolved through the base table.
+     */
+    struct TypedMethodTable {
+      std::unordered_map<Key, std::unique_ptr<TypedMethodBase>> methods;
+      std::shared_ptr<TypedMethodTable> base;
+
+      const TypedMethodBase *find(const Key &key) const {
+        for (auto table = this; table; table = table->base.get()) {
+          if (auto it = table->methods.find(key); it != table->methods.end()) {
+            return it->second.get();
+          }
+        }
+        return nullptr;
+      }
+    };
+
+    template <class F, class = void> struct CallableSignature {
+      static constexpr bool defined = false;
+    };
+
+    template <class R, typename... Args> struct CallableSignature<R (*)(Args...)> {
+      static constexpr bool defined = true;
+      using Return = R;
+      using Arguments = std::tuple<Args...>;
+    };
+
+    template <class C, class R, typename... Args>
+    struct CallableSignature<R (C::*)(Args...) const> : CallableSignature<R (*)(Args...)> {};
+
+    template <class C, class R, typename... Args>
+    struct CallableSignature<R (C::*)(Args...)> : CallableSignature<R (*)(Args...)> {};
+
+    template <class F> struct CallableSignature<F, std::void_t<decltype(&F::operator())>>
+        : CallableSignature<decltype(&F::operator())> {};
+
+    template <class T, class Self> constexpr bool isTypedReceiver() {
+      using S = typename std::decay<Self>::type;
+      return std::is_lvalue_reference<Self>::value && std::is_base_of<S, T>::value;
+    }
+
+    template <class Arg> constexpr bool isTypedArgument() {
+      using A = typename std::decay<Arg>::type;
+      return (!std::is_reference<Arg>::value
+              || (std::is_lvalue_reference<Arg>::value
+                  && std::is_const<typename std::remove_reference<Arg>::type>::value))
+             && !std::is_same<A, revisited::AnyArguments>::value;
+    }
+
+    template <class T, class F, class R, class Self, typename... Args>
+    std::unique_ptr<TypedMethodBase> createTypedMethod(F &&f, std::tuple<Self, Args...> *) {
+      if constexpr (isTypedReceiver<T, Self>() && (isTypedArgument<Args>() && ...)) {
+        using Result = typename std::conditional<std::is_void<R>::value, void,
+                                                 typename std::decay<R>::type>::type;
+        auto method = std::make_unique<TypedMethod<Result, typename std::decay<Args>::type...>>();
+        method->function = [f = std::forward<F>(f)](const revisited::Any &self,
+                                                    const typename std::decay<Args>::type &...args)
+            -> Result { return f(self.get<Self>(), args...); };
+        return method;
+      } else {
+        return nullptr;
+      }
+    }
+
+    template <class T, class F, class R> std::unique_ptr<TypedMethodBase> createTypedMethod(
+        F &&, std::tuple<> *) {
+      return nullptr;
+    }
+
+    /**
+     * Creates a typed method for callables taking a reference to `T` (or a base) as first
+     * argument and the remaining arguments by value or const reference.
+     * Returns `nullptr` for other callables.
+     */
+    template <class T, class F> std::unique_ptr<TypedMethodBase> createTypedMethod(F &&f) {
+      using Signature = CallableSignature<typename std::decay<F>::type>;
+      if constexpr (Signature::defined) {
+        return createTypedMethod<T, F, typename Signature::Return>(
+            std::forward<F>(f), static_cast<typename Signature::Arguments *>(nullptr));
+      } else {
+        return nullptr;
+      }
+    }
+
+  }  // namespace detail
+
+}  // namespace glue
@@ -10,16 +10,19 @@
 namespace glue {
 
   template <class T> struct EnumGenerator : public ValueBase {
-    MapValue data = createAnyMap();
+    MapValue data;
 
-    EnumGenerator() {
+    /**
+     * @param map the map that will store the enum data, e.g. `createFlatMap()`
+     */
+    explicit EnumGenerator(MapValue map = createAnyMap()) : data(std::move(map)) {
       setClassInfo<T>(data);
       data[keys::operators::eq] = [](T a, T b) { return a == b; };
       data["value"]
           = [](const T &a) { return static_cast<typename std::underlying_type<T>::type>(a); };
     }
 
-    EnumGenerator &addValue(const std::string &key, T value) {
+    EnumGenerator &addValue(const Key &key, T value) {
       data[key] = value;
       return *this;
     }
@@ -27,6 +30,8 @@ namespace glue {
     operator MapValue() const { return data; }
   };
 
-  template <class T> auto createEnum() { return EnumGenerator<T>(); }
+  template <class T> auto createEnum(MapValue map = createAnyMap()) {
+    return EnumGenerator<T>(std::move(map));
+  }
 
 }  // namespace glue
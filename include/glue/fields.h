@@ -0,0 +1,154 @@
+#pragma once
+
+#include <glue/instance.h>
+#include <glue/key.h>
+#include <revisited/any.h>
+
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace glue {
+
+  /**
+   * Describes the location of a member inside objects of a standard-layout class, allowing
+   * direct access without calling the member's accessors.
+   */
+  struct FieldDescriptor {
+    Key name;
+    revisited::TypeID type;
+    size_t offset = 0;
+    size_t size = 0;
+    bool readOnly = false;
+
+    /**
+     * Copies the field of `count` objects, `stride` bytes apart, into a `std::vector` of the
+     * field type and back.
+     */
+    revisited::Any (*gather)(const FieldDescriptor &, const void *first, size_t stride,
+                             size_t count)
+        = nullptr;
+    void (*scatter)(const FieldDescriptor &, void *first, size_t stride, size_t count,
+                    const revisited::Any &column)
+        = nullptr;
+
+    template <class O> const O &get(const void *object) const {
+      if (type != revisited::getTypeID<O>()) throw std::runtime_error("field type mismatch");
+      return *reinterpret_cast<const O *>(static_cast<const char *>(object) + offset);
+    }
+
+    template <class O> O &get(void *object) const {
+      if (type != revisited::getTypeID<O>()) throw std::runtime_error("field type mismatch");
+      if (readOnly) throw std::runtime_error("field is read-only");
+      return *reinterpret_cast<O *>(static_cast<char *>(object) + offset);
+    }
+  };
+
+  /**
+   * The trivially copyable members of a class, recorded by `ClassGenerator`.
+   * Fields of base classes are included if they were added to the derived class.
+   */
+  struct FieldTable {
+    /**
+     * The class containing the fields
+     */
+    revisited::TypeID type;
+    std::vector<FieldDescriptor> fields;
+
+    /**
+     * Return the address of the object held by an instance of the class or `nullptr`.
+     */
+    const void *(*getConstObject)(const revisited::Any &) = nullptr;
+    void *(*getObject)(const revisited::Any &) = nullptr;
+
+    const FieldDescriptor *find(const Key &name) const {
+      for (auto &field : fields) {
+        if (field.name == name) return &field;
+      }
+      return nullptr;
+    }
+
+    void erase(const Key &name);
+  };
+
+  namespace detail {
+
+    template <class T> const void *getConstObject(const revisited::Any &value) {
+      return value.getShared<const T>().get();
+    }
+
+    template <class T> void *getObject(const revisited::Any &value) {
+      return value.getShared<T>().get();
+    }
+
+    /**
+     * Members that can be copied in and out of fields and columns
+     */
+    template <class O> struct IsFieldType
+        : std::bool_constant<std::is_trivially_copyable<O>::value && !std::is_const<O>::value
+                             && !std::is_array<O>::value
+                             && std::is_default_constructible<O>::value
+                             && std::is_copy_assignable<O>::value> {};
+
+    template <class O> revisited::Any gatherField(const FieldDescriptor &field,
+                                                  const void *first, size_t stride,
+                                                  size_t count) {
+      std::vector<O> column(count);
+      auto source = static_cast<const char *>(first) + field.offset;
+      for (size_t i = 0; i < count; ++i, source += stride) {
+        column[i] = *reinterpret_cast<const O *>(source);
+      }
+      return revisited::Any(std::move(column));
+    }
+
+    template <class O> void scatterField(const FieldDescriptor &field, void *first,
+                                         size_t stride, size_t count,
+                                         const revisited::Any &value) {
+      if (field.readOnly) throw std::runtime_error("field " + field.name.str() + " is read-only");
+      auto &column = value.get<const std::vector<O> &>();
+      if (column.size() != count) throw std::runtime_error("column size mismatch");
+      auto target = static_cast<char *>(first) + field.offset;
+      for (size_t i = 0; i < count; ++i, target += stride) {
+        *reinterpret_cast<O *>(target) = column[i];
+      }
+    }
+
+    template <class T, class O> FieldDescriptor createFieldDescriptor(const Key &name,
+                                                                      O T::*ptr) {
+      // compute the offset on uninitialized storage, the member is never accessed
+      alignas(T) unsigned char storage[sizeof(T)];
+      auto object = reinterpret_cast<const T *>(storage);
+      FieldDescriptor field;
+      field.name = name;
+      field.type = revisited::getTypeID<O>();
+      field.offset = size_t(reinterpret_cast<const unsigned char *>(&(object->*ptr)) - storage);
+      field.size = sizeof(O);
+      field.gather = gatherField<O>;
+      field.scatter = scatterField<O>;
+      return field;
+    }
+
+  }  // namespace detail
+
+  /**
+   * Returns the field table of a class map or `nullptr` if the class has no fields.
+   */
+  inline std::shared_ptr<const FieldTable> getFieldTable(const MapValue &classMap) {
+    return classMap.rawGet(keys::fieldsKey)->getShared<const FieldTable>();
+  }
+
+  /**
+   * Copies the named fields of an instance into `buffer` in order and without padding.
+   * Fields are looked up in the field table of the instance's class, throws if one is missing.
+   */
+  void readFields(const Instance &instance, const std::vector<Key> &fields, void *buffer);
+
+  /**
+   * Copies the named fields of an instance from `buffer` in order and without padding.
+   * Throws if the instance is const or a field is missing or read-only.
+   */
+  void writeFields(const Instance &instance, const std::vector<Key> &fields, const void *buffer);
+
+}  // namespace glue
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <glue/map.h>
+#include <glue/value.h>
+
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+namespace glue {
+
+  /**
+   * A map storing its entries contiguously in insertion order.
+   * Small maps are searched linearly, larger maps use an open-addressing index with linear
+   * probing. Keys are interned, so entries only hold a key handle and comparisons are pointer
+   * comparisons.
+   */
+  struct FlatAnyMap : public Map {
+    /**
+     * Maps with at most this many entries are searched linearly without an index.
+     */
+    static constexpr size_t smallSize = 8;
+
+    FlatAnyMap() = default;
+
+    /**
+     * Allocates the entries and index from `resource`. The stored values are boxed independently.
+     */
+    explicit FlatAnyMap(std::pmr::memory_resource *resource) : entries(resource), index(resource) {}
+
+    Any get(const Key &key) const;
+    void set(const Key &key, const Any &value);
+    bool forEach(const std::function<bool(const std::string &)> &callback) const;
+
+    uint64_t version() const { return currentVersion; }
+
+    size_t size() const { return entries.size(); }
+    void reserve(size_t size);
+
+  private:
+    std::pmr::vector<std::pair<Key, Any>> entries;
+    uint64_t currentVersion = 1;
+
+    /**
+     * Open-addressing slots containing entry indices offset by one, zero marks an empty slot.
+     * Empty while the map is in small mode.
+     */
+    std::pmr::vector<uint32_t> index;
+
+    /**
+     * Returns the position of the entry or `entries.size()` if not found.
+     */
+    size_t find(const Key &key) const;
+    void insertIndex(uint32_t entry);
+    void rebuildIndex(size_t capacity);
+  };
+
+}  // namespace glue
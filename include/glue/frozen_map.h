@@ -0,0 +1,74 @@
+#pragma once
+
+#include <glue/map.h>
+#include <glue/value.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace glue {
+
+  /**
+   * An immutable map using a perfect hash over its keys.
+   * Lookups are a single probe into contiguous storage. As the map is never modified, it
+   * requires no locking and can be shared across threads. Lookups of undefined keys continue
+   * through the extends entry, so they are only thread-safe while the base maps aren't modified.
+   */
+  class FrozenMap : public Map {
+  public:
+    struct Entry {
+      Key key;
+      Any value;
+      /**
+       * `true` for entries copied from the extends chain, which are not enumerated
+       */
+      bool inherited;
+    };
+
+    /**
+     * Throws if a key occurs more than once.
+     */
+    explicit FrozenMap(std::vector<Entry> entries);
+
+    Any get(const Key &key) const;
+
+    /**
+     * Throws, as frozen maps cannot be modified
+     */
+    void set(const Key &key, const Any &value);
+
+    bool forEach(const std::function<bool(const std::string &)> &callback) const;
+
+    size_t size() const { return count; }
+
+  private:
+    /**
+     * The number of table sizes tried before giving up
+     */
+    static constexpr size_t maxAttempts = 16;
+
+    /**
+     * The table, which may contain unused slots with an empty key
+     */
+    std::vector<Entry> entries;
+    std::vector<uint32_t> displacements;
+    size_t count;
+
+    size_t slot(const Key &key) const;
+
+    /**
+     * Computes the displacements for a table of `size` slots and returns the slot of each entry,
+     * or an empty vector if a bucket can't be placed within a bounded number of attempts.
+     */
+    std::vector<size_t> place(const std::vector<Entry> &source, size_t size);
+  };
+
+  /**
+   * Creates an immutable copy of the map.
+   * Entries inherited through the extends chain are copied into the table, so base maps should
+   * not be modified afterwards. Extends callbacks are still resolved when looking up
+   * undefined keys.
+   */
+  MapValue createFrozenMap(const MapValue &map);
+
+}  // namespace glue
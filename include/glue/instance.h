@@ -1,18 +1,39 @@
 #pragma once
 
+#include <glue/detail/typed_method.h>
+#include <glue/keys.h>
 #include <glue/value.h>
 
+#include <array>
 #include <cassert>
 
 namespace glue {
 
+  struct BoundMethod;
+
+  namespace detail {
+
+    /**
+     * Returns the typed method for `key` if the class map still resolves the key to the function
+     * it was created from, otherwise `nullptr`.
+     */
+    inline const TypedMethodBase *findTypedMethod(const MapValue &classMap, const Key &key) {
+      auto table = classMap.rawGet(keys::typedMethodsKey)->template getShared<TypedMethodTable>();
+      if (!table) return nullptr;
+      auto method = table->find(key);
+      if (!method || method->sourceIdentity != functionIdentity(*classMap.get(key))) return nullptr;
+      return method;
+    }
+
+  }  // namespace detail
+
   struct Instance : public Value {
     MapValue classMap;
 
     Instance(){};
     Instance(MapValue c, Value v) : Value(std::move(v)), classMap(std::move(c)) {}
 
-    auto operator[](const std::string &key) const {
+    auto operator[](const Key &key) const {
       return [=](auto &&...args) {
         if (!*this) {
           throw std::runtime_error("called method on undefined instance");
@@ -21,6 +42,101 @@ namespace glue {
             **this, detail::convertArgumentToAny(std::forward<decltype(args)>(args))...);
       };
     }
+
+    /**
+     * Resolves the method once and returns a handle that can be called repeatedly without
+     * further lookups. The handle shares the instance's value, so it stays valid on its own.
+     */
+    BoundMethod method(const Key &key) const;
+
+    /**
+     * Calls a method with native argument and return types.
+     * Methods registered through `ClassGenerator` with exactly matching (decayed) argument and
+     * return types are invoked without boxing, other methods fall back to a regular call, as do
+     * methods whose map entry has been replaced outside of the generator.
+     */
+    template <class R, typename... Args> R call(const Key &key, Args &&...args) const {
+      if (!*this) {
+        throw std::runtime_error("called method on undefined instance");
+      }
+      using Method = detail::TypedMethod<R, typename std::decay<Args>::type...>;
+      if (auto method = dynamic_cast<const Method *>(detail::findTypedMethod(classMap, key))) {
+        return method->function(**this, args...);
+      }
+      auto result = (*this)[key](std::forward<Args>(args)...);
+      if constexpr (!std::is_void<R>::value) {
+        return result.template get<R>();
+      }
+    }
+
+    /**
+     * Calls a method without boxing arithmetic, boolean and string arguments and results.
+     * Typed methods whose parameters accept the inline arguments are called directly, other
+     * methods fall back to a regular call with boxed arguments.
+     */
+    template <typename... Args> InlineValue invoke(const Key &key, Args &&...args) const {
+      if (!*this) {
+        throw std::runtime_error("called method on undefined instance");
+      }
+      std::array<InlineValue, sizeof...(Args)> arguments{InlineValue(std::forward<Args>(args))...};
+      if (auto method = detail::findTypedMethod(classMap, key)) {
+        InlineValue result;
+        if (method->callInline(**this, arguments.data(), arguments.size(), result)) {
+          return result;
+        }
+      }
+      auto function = classMap[key].asFunction();
+      if (!function) {
+        throw std::runtime_error("instance has no method " + key.str());
+      }
+      AnyArguments boxed;
+      boxed.reserve(arguments.size() + 1);
+      boxed.push_back(**this);
+      for (auto &argument : arguments) boxed.push_back(argument.toAny());
+      return InlineValue(function.call(boxed));
+    }
   };
 
+  /**
+   * A method resolved from an instance's class map, bound to the instance's value.
+   */
+  struct BoundMethod {
+    Any receiver;
+    MapValue classMap;
+    AnyFunction function;
+
+    explicit operator bool() const { return bool(function); }
+
+    /**
+     * Binds the resolved method to another instance of the same class without a lookup.
+     */
+    BoundMethod rebind(const Instance &other) const {
+      if (!function) {
+        throw std::runtime_error("cannot rebind an empty method binding");
+      }
+      if (other.classMap.data != classMap.data) {
+        throw std::runtime_error("cannot rebind method to an instance of another class");
+      }
+      return BoundMethod{*other, other.classMap, function};
+    }
+
+    template <typename... Args> Any operator()(Args &&...args) const {
+      if (!function || !receiver) {
+        throw std::runtime_error("called method on undefined instance");
+      }
+      return function(receiver, detail::convertArgumentToAny(std::forward<Args>(args))...);
+    }
+  };
+
+  inline BoundMethod Instance::method(const Key &key) const {
+    if (!*this) {
+      throw std::runtime_error("called method on undefined instance");
+    }
+    if (auto function = classMap.get(key).asFunction()) {
+      return BoundMethod{**this, classMap, std::move(function)};
+    } else {
+      throw std::runtime_error("instance has no method " + key.str());
+    }
+  }
+
 }  // namespace glue
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <functional>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace glue {
+
+  namespace detail {
+    struct KeyData {
+      std::string name;
+      size_t hash;
+    };
+
+    /**
+     * Returns the unique interned data for the given name.
+     * The returned pointer stays valid for the lifetime of the program. Repeated lookups on the
+     * same thread are usually served from a bounded thread-local cache without locking.
+     */
+    const KeyData *internKey(std::string_view name);
+
+    /**
+     * Returns the interned data for the given name or `nullptr` if it has never been interned.
+     */
+    const KeyData *findKey(std::string_view name);
+  }  // namespace detail
+
+  /**
+   * An interned map key.
+   * Keys with the same name share a single global instance, so copying, hashing and comparing
+   * keys is a pointer operation. Creating a key from a string requires hashing the string and a
+   * lookup in a thread-local cache, falling back to the locked global intern table, so keys used
+   * on hot paths should be created once and reused. Interned keys are never released, so
+   * creating keys from unbounded dynamic strings grows the intern table for the lifetime of the
+   * program. Lookups by dynamic names should use `Key::find`, which never interns.
+   */
+  class Key {
+  private:
+    const detail::KeyData *data;
+
+    explicit Key(const detail::KeyData *d) : data(d) {}
+
+  public:
+    Key() : Key(std::string_view()) {}
+    Key(std::string_view name) : data(detail::internKey(name)) {}
+    Key(const std::string &name) : Key(std::string_view(name)) {}
+    Key(const char *name) : Key(std::string_view(name)) {}
+
+    /**
+     * Returns the key with the given name if it has been created before. As maps can only
+     * contain created keys, an absent key can be treated as a miss.
+     */
+    static std::optional<Key> find(std::string_view name) {
+      if (auto data = detail::findKey(name)) return Key(data);
+      return std::nullopt;
+    }
+
+    const std::string &str() const { return data->name; }
+    size_t hash() const { return data->hash; }
+
+    /**
+     * A unique identifier of the interned key, stable for the lifetime of the program.
+     */
+    const void *id() const { return data; }
+
+    operator const std::string &() const { return data->name; }
+
+    friend bool operator==(const Key &a, const Key &b) { return a.data == b.data; }
+    friend bool operator!=(const Key &a, const Key &b) { return a.data != b.data; }
+    friend bool operator<(const Key &a, const Key &b) { return a.str() < b.str(); }
+
+    friend std::ostream &operator<<(std::ostream &stream, const Key &key) {
+      return stream << key.str();
+    }
+  };
+
+}  // namespace glue
+
+namespace std {
+  template <> struct hash<glue::Key> {
+    size_t operator()(const glue::Key &key) const { return key.hash(); }
+  };
+}  // namespace std
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <glue/key.h>
+
+#include <string_view>
+
 namespace glue {
 
   /**
@@ -7,25 +11,32 @@ namespace glue {
    */
   namespace keys {
 
-    static constexpr auto constructorKey = "__new";
-    static constexpr auto extendsKey = "__glue_extends";
-    static constexpr auto classKey = "__glue_class";
+    /**
+     * The name of `constructorKey`, usable in constant expressions
+     */
+    inline constexpr std::string_view constructorName{"__new"};
+
+    inline const Key constructorKey{constructorName};
+    inline const Key extendsKey{"__glue_extends"};
+    inline const Key classKey{"__glue_class"};
+    inline const Key typedMethodsKey{"__glue_typed_methods"};
+    inline const Key fieldsKey{"__glue_fields"};
 
     namespace operators {
-      static constexpr auto eq = "__eq";
-      static constexpr auto lt = "__lt";
-      static constexpr auto le = "__le";
-      static constexpr auto gt = "__gt";
-      static constexpr auto ge = "__ge";
-      static constexpr auto mul = "__mul";
-      static constexpr auto div = "__div";
-      static constexpr auto idiv = "__idiv";
-      static constexpr auto add = "__add";
-      static constexpr auto sub = "__sub";
-      static constexpr auto mod = "__mod";
-      static constexpr auto pow = "__pow";
-      static constexpr auto unm = "__unm";
-      static constexpr auto tostring = "__tostring";
+      inline const Key eq{"__eq"};
+      inline const Key lt{"__lt"};
+      inline const Key le{"__le"};
+      inline const Key gt{"__gt"};
+      inline const Key ge{"__ge"};
+      inline const Key mul{"__mul"};
+      inline const Key div{"__div"};
+      inline const Key idiv{"__idiv"};
+      inline const Key add{"__add"};
+      inline const Key sub{"__sub"};
+      inline const Key mod{"__mod"};
+      inline const Key pow{"__pow"};
+      inline const Key unm{"__unm"};
+      inline const Key tostring{"__tostring"};
     }  // namespace operators
   }    // namespace keys
 
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <glue/class.h>
+#include <glue/map.h>
+#include <glue/value.h>
+
+#include <atomic>
+#include <mutex>
+#include <type_traits>
+#include <unordered_map>
+
+namespace glue {
+
+  /**
+   * A map whose entries can be registered as factories that are only invoked on the first
+   * lookup of their key. Building large APIs this way defers creating class maps and wrapping
+   * functions until a script actually uses them. `forEach` enumerates all keys without
+   * materializing any entries.
+   * Concurrent lookups are safe: factories run under a lock and materialized entries are read
+   * without locking. Modifications must not run concurrently with other accesses.
+   */
+  namespace detail {
+
+    template <class R> struct LazyClassHint {
+      static const ClassInfo *get() { return nullptr; }
+    };
+
+    template <class T> struct LazyClassHint<ClassGenerator<T>> {
+      static const ClassInfo *get() {
+        static const ClassInfo info = createClassInfo<T>();
+        return &info;
+      }
+    };
+
+  }  // namespace detail
+
+  class LazyMap : public Map {
+  public:
+    using Factory = std::function<Any()>;
+
+    Any get(const Key &key) const;
+    void set(const Key &key, const Any &value);
+    bool forEach(const std::function<bool(const std::string &)> &callback) const;
+    uint64_t version() const { return currentVersion; }
+
+    /**
+     * Registers a factory creating the value for `key` on first access, replacing any previous
+     * value. The result is converted like values assigned through `MapValue`, so factories can
+     * return class generators, maps or callables.
+     */
+    template <class F> void setFactory(const Key &key, F &&factory) {
+      using Result = typename std::decay<decltype(factory())>::type;
+      setFactoryFunction(
+          key,
+          [factory = std::forward<F>(factory)]() {
+            return detail::convertArgumentToAny(factory());
+          },
+          detail::LazyClassHint<Result>::get());
+    }
+
+    /**
+     * Returns `true` if the key is defined and its value has been created.
+     */
+    bool isMaterialized(const Key &key) const;
+
+    /**
+     * Returns the type information of the class an unmaterialized entry creates, if it is known
+     * without running the factory. This is the case for factories returning a `ClassGenerator`.
+     */
+    const ClassInfo *getClassHint(const Key &key) const;
+
+    size_t size() const { return entries.size(); }
+
+  private:
+    struct Entry {
+      Any value;
+      /**
+       * Set until the value has been created
+       */
+      Factory factory;
+      const ClassInfo *classHint = nullptr;
+      /**
+       * Set once `value` is final, so that it can be read without locking
+       */
+      std::atomic<bool> materialized{false};
+    };
+
+    mutable std::unordered_map<Key, Entry> entries;
+    /**
+     * Held while running factories, recursive as factories may look up other entries
+     */
+    mutable std::recursive_mutex factoryMutex;
+    uint64_t currentVersion = 1;
+
+    void setFactoryFunction(const Key &key, Factory factory, const ClassInfo *classHint);
+  };
+
+}  // namespace glue
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <glue/detail/resolution_cache.h>
+#include <glue/key.h>
 #include <revisited/any.h>
 #include <revisited/any_function.h>
 
@@ -14,9 +16,23 @@ namespace glue {
    * Any map implementation must implement this interface.
    */
   struct Map : public revisited::Visitable<Map> {
-    virtual Any get(const std::string &) const = 0;
-    virtual void set(const std::string &, const Any &) = 0;
+    virtual Any get(const Key &) const = 0;
+    virtual void set(const Key &, const Any &) = 0;
     virtual bool forEach(const std::function<bool(const std::string &)> &) const = 0;
+
+    /**
+     * Returns a counter that changes whenever the map is modified, or `0` if the map does not
+     * track modifications. Lookups through maps without version tracking are never cached.
+     */
+    virtual uint64_t version() const { return 0; }
+
+    /**
+     * Used by `MapValue::get` to cache lookups along the extends chain.
+     * The cache is updated without locks, so concurrent lookups are safe.
+     */
+    mutable detail::ResolutionCacheHolder resolutionCache;
+
+    virtual ~Map() {}
   };
 
 }  // namespace  glue
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <glue/map.h>
+#include <glue/value.h>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace glue {
+
+  /**
+   * Counters of a single key of a profiled map.
+   */
+  struct KeyProfile {
+    uint64_t gets = 0;
+    uint64_t sets = 0;
+    uint64_t misses = 0;
+
+    /**
+     * The total number of extends maps visited by lookups that were not found in the map itself,
+     * up to the map defining the key or the end of the chain
+     */
+    uint64_t extendsHops = 0;
+
+    uint64_t calls = 0;
+    uint64_t callNanoseconds = 0;
+
+    /**
+     * Call latencies, bucket `i` counts calls that took less than `2^i` nanoseconds and at least
+     * `2^(i-1)`. The last bucket counts all longer calls.
+     */
+    std::array<uint64_t, 40> latencyHistogram{};
+  };
+
+  namespace detail {
+    struct KeySlot;
+    struct MapProfile;
+    struct ProfileData;
+  }  // namespace detail
+
+  /**
+   * Collects access and call statistics of the maps wrapped by `wrap`.
+   * Copies of a profile share their data. Only wrapped maps are instrumented, so the rest of the
+   * library has no overhead and instrumentation can be enabled by wrapping the root map.
+   */
+  class Profile {
+  public:
+    struct Entry {
+      /**
+       * The dot-separated path of the map in the wrapped tree
+       */
+      std::string path;
+      std::string key;
+      KeyProfile counters;
+    };
+
+    Profile();
+
+    /**
+     * Returns a `ProfilingMap` over the map. Maps and functions returned by lookups through it
+     * are wrapped as well, so wrapping the root instruments the whole tree.
+     */
+    MapValue wrap(const MapValue &map, const std::string &name = "") const;
+
+    /**
+     * Returns the counters of all keys, sorted by total call time and then by access count.
+     */
+    std::vector<Entry> entries() const;
+
+    void printReport(std::ostream &stream) const;
+    void printJSON(std::ostream &stream) const;
+
+    /**
+     * Clears all counters.
+     */
+    void reset() const;
+
+  private:
+    friend class ProfilingMap;
+    std::shared_ptr<detail::ProfileData> data;
+  };
+
+  /**
+   * Returns the map wrapped by a `ProfilingMap`, or the map itself if it is not profiled.
+   */
+  MapValue unwrapProfiling(const MapValue &map);
+
+  /**
+   * A decorator counting the lookups and assignments of another map and measuring the calls of
+   * its functions. Counters are atomic and the wrappers of nested maps and functions are created
+   * once per value, so lookups only take a shared lock.
+   * Functions are replaced by variadic wrappers, so their signatures are not visible through the
+   * profiled map. `DeclarationPrinter` and `writeSchema` therefore unwrap profiled roots.
+   * Typed methods are hidden, so that `Instance::call` falls back to the measured functions.
+   * The map does not track versions, so lookups through the extends chain are never cached and
+   * every access is counted.
+   */
+  class ProfilingMap : public Map {
+  public:
+    ProfilingMap(std::shared_ptr<Map> inner, Profile profile, const std::string &name);
+
+    Any get(const Key &key) const;
+    void set(const Key &key, const Any &value);
+    bool forEach(const std::function<bool(const std::string &)> &callback) const;
+
+    const std::shared_ptr<Map> &getInner() const { return inner; }
+
+  private:
+    friend class Profile;
+    std::shared_ptr<Map> inner;
+    Profile profile;
+    std::shared_ptr<detail::MapProfile> mapProfile;
+
+    /**
+     * The counters of a looked up key and the wrapper returned for its current value
+     */
+    struct Entry {
+      std::shared_ptr<detail::KeySlot> slot;
+      const void *source = nullptr;
+      Any value;
+      Any wrapper;
+    };
+    mutable std::shared_mutex mutex;
+    mutable std::unordered_map<Key, Entry> entries;
+
+    static Any wrapFunction(const AnyFunction &function,
+                            const std::shared_ptr<detail::KeySlot> &slot);
+  };
+
+}  // namespace glue
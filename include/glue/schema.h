@@ -0,0 +1,126 @@
+#pragma once
+
+#include <glue/context.h>
+#include <glue/value.h>
+
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+
+namespace glue {
+
+  /**
+   * A binary description of a map tree that can be memory-mapped and queried in place.
+   * All records consist of 32-bit integers in the byte order of the writing host.
+   *
+   * Layout: `Header`, string table, type table, node table, parameter table.
+   * The children of each node are stored contiguously and sorted by name.
+   */
+  namespace schema {
+
+    constexpr char magic[4] = {'G', 'L', 'U', 'S'};
+    constexpr uint32_t version = 1;
+    constexpr uint32_t byteOrderMark = 0x01020304;
+
+    /**
+     * Marks undefined type and node indices
+     */
+    constexpr uint32_t none = 0xffffffff;
+
+    struct StringRef {
+      uint32_t offset;
+      uint32_t size;
+    };
+
+    struct Header {
+      char magic[4];
+      uint32_t version;
+      uint32_t byteOrderMark;
+      uint32_t stringOffset, stringSize;
+      uint32_t typeOffset, typeCount;
+      uint32_t nodeOffset, nodeCount;
+      uint32_t parameterOffset, parameterCount;
+    };
+
+    struct TypeRecord {
+      /**
+       * The C++ type name
+       */
+      StringRef name;
+
+      /**
+       * The dot-separated path of the class in the context, empty if not registered
+       */
+      StringRef path;
+    };
+
+    enum class NodeKind : uint32_t {
+      Module,
+      Class,
+      Function,
+      Method,
+      StaticMethod,
+      Constructor,
+      Value
+    };
+
+    enum NodeFlags : uint32_t { Variadic = 1 };
+
+    struct NodeRecord {
+      NodeKind kind;
+      uint32_t flags;
+      StringRef name;
+      /**
+       * The class type, value type or function return type
+       */
+      uint32_t type;
+      /**
+       * The type of the extended class for classes
+       */
+      uint32_t extends;
+      uint32_t firstChild, childCount;
+      /**
+       * Parameter types of functions, excluding the receiver of methods
+       */
+      uint32_t firstParameter, parameterCount;
+    };
+
+  }  // namespace schema
+
+  /**
+   * Writes the schema of a map tree. The root is node `0`, a module without name.
+   * Types are named using the context, if given.
+   */
+  void writeSchema(std::ostream &stream, const MapValue &root, const Context *context = nullptr);
+
+  /**
+   * Read-only access to a schema stored in memory.
+   * Only the header is validated on construction, accessors check bounds when called.
+   */
+  class SchemaView {
+  public:
+    /**
+     * Throws if the data is not a schema of a supported version.
+     */
+    SchemaView(const void *data, size_t size);
+
+    const schema::Header &header() const { return *headerRecord; }
+    const schema::NodeRecord &root() const { return node(0); }
+    const schema::NodeRecord &node(uint32_t index) const;
+    const schema::TypeRecord &type(uint32_t index) const;
+    const schema::NodeRecord &child(const schema::NodeRecord &node, uint32_t index) const;
+    uint32_t parameter(const schema::NodeRecord &node, uint32_t index) const;
+    std::string_view string(schema::StringRef ref) const;
+
+    /**
+     * Returns the child with the given name using binary search or `nullptr`.
+     */
+    const schema::NodeRecord *find(const schema::NodeRecord &node, std::string_view name) const;
+
+  private:
+    const char *data;
+    size_t size;
+    const schema::Header *headerRecord;
+  };
+
+}  // namespace glue
@@ -0,0 +1,409 @@
+#pragma once
+
+#include <glue/class.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
+
+namespace glue {
+
+  namespace detail {
+
+    /**
+     * The name of an entry of a static class.
+     * Setters are named `set` followed by the capitalized member name, so names never need to
+     * be allocated.
+     */
+    struct StaticName {
+      std::string_view name;
+      bool setter = false;
+      /**
+       * The position of the descriptor and the index of the entry within it
+       */
+      size_t descriptor = 0;
+      size_t index = 0;
+
+      constexpr size_t size() const { return setter ? name.size() + 3 : name.size(); }
+
+      constexpr char operator[](size_t i) const {
+        if (!setter) return name[i];
+        if (i < 3) return "set"[i];
+        if (i == 3 && name[0] >= 'a' && name[0] <= 'z') return char(name[0] - 'a' + 'A');
+        return name[i - 3];
+      }
+
+      std::string str() const {
+        std::string result(size(), ' ');
+        for (size_t i = 0; i < result.size(); ++i) result[i] = (*this)[i];
+        return result;
+      }
+
+      /**
+       * Calls `f` with the name as a string view, only allocating for long setter names
+       */
+      template <class F> auto withView(F &&f) const {
+        if (!setter) return f(name);
+        std::array<char, 64> buffer;
+        if (size() > buffer.size()) return f(std::string_view(str()));
+        for (size_t i = 0; i < size(); ++i) buffer[i] = (*this)[i];
+        return f(std::string_view(buffer.data(), size()));
+      }
+
+      /**
+       * The hash of the name, equal to the hash of a `Key` with the same name
+       */
+      size_t hash() const {
+        return withView([](std::string_view view) { return std::hash<std::string_view>()(view); });
+      }
+
+      Key key() const {
+        return withView([](std::string_view view) { return Key(view); });
+      }
+    };
+
+    /**
+     * Three-way comparison of two names, ordering by characters and then by length
+     */
+    template <class A, class B> constexpr int compareNames(const A &a, const B &b) {
+      auto size = std::min(a.size(), b.size());
+      for (size_t i = 0; i < size; ++i) {
+        if (a[i] != b[i]) return a[i] < b[i] ? -1 : 1;
+      }
+      return a.size() < b.size() ? -1 : a.size() > b.size() ? 1 : 0;
+    }
+
+    /**
+     * Collects the entry names of all descriptors, sorted stably so that later definitions of
+     * the same name follow earlier ones.
+     */
+    template <size_t N, class Descriptors, size_t... I>
+    constexpr std::array<StaticName, N> sortedNames(const Descriptors &descriptors,
+                                                    std::index_sequence<I...>) {
+      std::array<StaticName, N> names{};
+      size_t count = 0;
+      (
+          [&](const auto &descriptor) {
+            for (size_t j = 0; j < descriptor.size; ++j) {
+              auto name = descriptor.entryName(j);
+              name.descriptor = I;
+              name.index = j;
+              names[count++] = name;
+            }
+          }(std::get<I>(descriptors)),
+          ...);
+      for (size_t i = 1; i < N; ++i) {
+        auto name = names[i];
+        auto j = i;
+        for (; j > 0 && compareNames(name, names[j - 1]) < 0; --j) names[j] = names[j - 1];
+        names[j] = name;
+      }
+      return names;
+    }
+
+    template <class T, class B, class R, typename... Args> auto bindCallable(R (B::*f)(Args...)) {
+      static_assert(std::is_base_of<B, T>::value);
+      return [f](T &o, Args... args) { return std::invoke(f, o, std::forward<Args>(args)...); };
+    }
+
+    template <class T, class B, class R, typename... Args>
+    auto bindCallable(R (B::*f)(Args...) const) {
+      static_assert(std::is_base_of<B, T>::value);
+      return
+          [f](const T &o, Args... args) { return std::invoke(f, o, std::forward<Args>(args)...); };
+    }
+
+    template <class T, class F> F bindCallable(F f) { return f; }
+
+  }  // namespace detail
+
+  /**
+   * Descriptors of static class entries, see `createStaticClass`.
+   * Descriptors only hold names and pointers and can be constructed in constant expressions.
+   */
+  namespace bind {
+
+    template <typename... Args> struct Constructor {
+      static constexpr size_t size = 1;
+
+      constexpr detail::StaticName entryName(size_t) const { return {keys::constructorName}; }
+
+      template <class T> Any create(size_t) const {
+        return detail::convertArgumentToAny(
+            [](Args... args) { return T(std::forward<Args>(args)...); });
+      }
+
+      template <class T> std::unique_ptr<detail::TypedMethodBase> createTyped(size_t) const {
+        return nullptr;
+      }
+    };
+
+    template <class F> struct Method {
+      static constexpr size_t size = 1;
+      std::string_view name;
+      F function;
+
+      constexpr detail::StaticName entryName(size_t) const { return {name}; }
+
+      template <class T> Any create(size_t) const {
+        return detail::convertArgumentToAny(detail::bindCallable<T>(function));
+      }
+
+      template <class T> std::unique_ptr<detail::TypedMethodBase> createTyped(size_t) const {
+        return detail::createTypedMethod<T>(detail::bindCallable<T>(function));
+      }
+    };
+
+    /**
+     * A member with a getter named `name` and, unless `Const`, a setter named `setName`.
+     */
+    template <class C, class O, bool Const> struct Member {
+      static constexpr size_t size = Const ? 1 : 2;
+      std::string_view name;
+      O C::*ptr;
+
+      constexpr detail::StaticName entryName(size_t i) const { return {name, i == 1}; }
+
+      template <class T> auto callable(size_t i) const {
+        static_assert(std::is_base_of<C, T>::value);
+        auto ptr = this->ptr;
+        auto getter = [ptr](const T &o) { return o.*ptr; };
+        if constexpr (Const) {
+          (void)i;
+          return getter;
+        } else if constexpr (std::is_fundamental<O>::value) {
+          auto setter = [ptr](T &o, O v) { o.*ptr = std::move(v); };
+          return std::make_pair(getter, setter);
+        } else {
+          auto setter = [ptr](T &o, const O &v) { o.*ptr = v; };
+          return std::make_pair(getter, setter);
+        }
+      }
+
+      template <class T> Any create(size_t i) const {
+        if constexpr (Const) {
+          return detail::convertArgumentToAny(callable<T>(i));
+        } else {
+          auto accessors = callable<T>(i);
+          return i == 0 ? detail::convertArgumentToAny(accessors.first)
+                        : detail::convertArgumentToAny(accessors.second);
+        }
+      }
+
+      template <class T> std::unique_ptr<detail::TypedMethodBase> createTyped(size_t i) const {
+        if constexpr (Const) {
+          return detail::createTypedMethod<T>(callable<T>(i));
+        } else {
+          auto accessors = callable<T>(i);
+          return i == 0 ? detail::createTypedMethod<T>(accessors.first)
+                        : detail::createTypedMethod<T>(accessors.second);
+        }
+      }
+    };
+
+    template <typename... Args> constexpr Constructor<Args...> constructor() { return {}; }
+
+    template <class F> constexpr Method<F> method(std::string_view name, F f) {
+      return {name, f};
+    }
+
+    template <class C, class O> constexpr Member<C, O, false> member(std::string_view name,
+                                                                     O C::*ptr) {
+      return {name, ptr};
+    }
+
+    template <class C, class O> constexpr Member<C, O, true> constMember(std::string_view name,
+                                                                         O C::*ptr) {
+      return {name, ptr};
+    }
+
+  }  // namespace bind
+
+  /**
+   * A class map whose entries are fixed by descriptors at compile time.
+   * Names are interned on construction, so that they can be found through `Key::find`, and
+   * indexed by key identity. Values are only created on their first lookup. Apart from the
+   * extends key, the map can't be modified. Lookups are thread-safe, changing the extends key is
+   * not.
+   */
+  template <class T, class Bases, class... Descriptors> class StaticClass : public Map {
+  public:
+    static constexpr size_t size = (Descriptors::size + ... + 0);
+
+    explicit StaticClass(Descriptors... descriptors)
+        : descriptors(std::move(descriptors)...),
+          names(detail::sortedNames<size>(this->descriptors,
+                                          std::index_sequence_for<Descriptors...>())) {
+      auto mask = indexSize - 1;
+      for (size_t i = 0; i < size; ++i) {
+        // only index the last definition of each name
+        if (i + 1 < size && detail::compareNames(names[i], names[i + 1]) == 0) continue;
+        auto key = names[i].key();
+        auto slot = key.hash() & mask;
+        while (index[slot].position != size) slot = (slot + 1) & mask;
+        index[slot].id = key.id();
+        index[slot].position = i;
+      }
+    }
+
+    Any get(const Key &key) const {
+      if (key == keys::classKey) {
+        if (!classInfoReady.load(std::memory_order_acquire)) {
+          std::call_once(classInfoCreated, [this]() {
+            classInfo = createClassInfo<T>(Bases());
+            classInfoReady.store(true, std::memory_order_release);
+          });
+        }
+        return classInfo;
+      } else if (key == keys::typedMethodsKey) {
+        getTypedMethods();
+        return typedMethodsValue;
+      } else if (key == keys::extendsKey) {
+        return extends;
+      }
+      auto i = find(key);
+      if (i == size) return Any();
+      if (!ready[i].load(std::memory_order_acquire)) {
+        std::call_once(created[i], [&]() {
+          auto &name = names[i];
+          visit(name.descriptor,
+                [&](auto &descriptor) { values[i] = descriptor.template create<T>(name.index); });
+          ready[i].store(true, std::memory_order_release);
+        });
+      }
+      return values[i];
+    }
+
+    /**
+     * Sets the extends key, throws for all other keys.
+     */
+    void set(const Key &key, const Any &value) {
+      if (key != keys::extendsKey) {
+        throw std::runtime_error("static classes cannot be modified");
+      }
+      extends = value;
+      if (typedMethods) {
+        typedMethods->base = baseTypedMethods();
+      }
+    }
+
+    bool forEach(const std::function<bool(const std::string &)> &callback) const {
+      if (callback(keys::classKey.str()) || callback(keys::typedMethodsKey.str())) return true;
+      if (extends && callback(keys::extendsKey.str())) return true;
+      for (size_t i = 0; i < size; ++i) {
+        if (i + 1 < size && detail::compareNames(names[i], names[i + 1]) == 0) continue;
+        if (callback(names[i].str())) return true;
+      }
+      return false;
+    }
+
+  private:
+    std::tuple<Descriptors...> descriptors;
+    std::array<detail::StaticName, size> names;
+    mutable std::array<Any, size> values;
+    mutable std::array<std::once_flag, size> created;
+    /**
+     * Set once the corresponding value has been created, so later lookups skip `call_once`
+     */
+    mutable std::array<std::atomic<bool>, size> ready{};
+    mutable Any classInfo;
+    mutable std::once_flag classInfoCreated;
+    mutable std::atomic<bool> classInfoReady{false};
+    mutable std::shared_ptr<detail::TypedMethodTable> typedMethods;
+    /**
+     * The table boxed once, so typed calls don't allocate
+     */
+    mutable Any typedMethodsValue;
+    mutable std::once_flag typedMethodsCreated;
+    mutable std::atomic<bool> typedMethodsReady{false};
+    Any extends;
+
+    static constexpr size_t indexSize = []() {
+      size_t result = 1;
+      while (result < 2 * size) result *= 2;
+      return result;
+    }();
+
+    /**
+     * A slot of the open-addressing index from key ids to positions in `names`
+     */
+    struct Slot {
+      const void *id = nullptr;
+      size_t position = size;
+    };
+    std::array<Slot, indexSize> index;
+
+    /**
+     * Returns the position of the last entry named `key` or `size` if there is none.
+     */
+    size_t find(const Key &key) const {
+      auto mask = indexSize - 1;
+      for (auto slot = key.hash() & mask;; slot = (slot + 1) & mask) {
+        auto &entry = index[slot];
+        if (entry.position == size) return size;
+        if (entry.id == key.id()) return entry.position;
+      }
+    }
+
+    template <class F> void visit(size_t descriptor, F &&f) const {
+      std::apply(
+          [&](auto &...d) {
+            size_t i = 0;
+            ((i++ == descriptor ? f(d) : void()), ...);
+          },
+          descriptors);
+    }
+
+    std::shared_ptr<detail::TypedMethodTable> baseTypedMethods() const {
+      if (auto base = Value(extends).asMap()) {
+        return base.rawGet(keys::typedMethodsKey)
+            ->template getShared<detail::TypedMethodTable>();
+      }
+      return nullptr;
+    }
+
+    const std::shared_ptr<detail::TypedMethodTable> &getTypedMethods() const {
+      if (typedMethodsReady.load(std::memory_order_acquire)) return typedMethods;
+      std::call_once(typedMethodsCreated, [this]() {
+        auto table = std::make_shared<detail::TypedMethodTable>();
+        for (auto &name : names) {
+          Key key(name.str());
+          visit(name.descriptor, [&](auto &descriptor) {
+            auto method = descriptor.template createTyped<T>(name.index);
+            // later entries of the same name replace earlier ones, as in `get`
+            if (method) method->setSource(get(key));
+            table->methods[key] = std::move(method);
+          });
+        }
+        table->base = baseTypedMethods();
+        typedMethods = std::move(table);
+        typedMethodsValue = Any(typedMethods);
+        typedMethodsReady.store(true, std::memory_order_release);
+      });
+      return typedMethods;
+    }
+  };
+
+  /**
+   * Creates a class map from entry descriptors, e.g.
+   * `createStaticClass<A>(bind::constructor<>(), bind::method("add", &A::add))`.
+   * Unlike `ClassGenerator`, creating the class only allocates the map itself and interns its
+   * names.
+   */
+  template <class T, class... Bases, class... Descriptors>
+  MapValue createStaticClass(WithBases<Bases...>, Descriptors... descriptors) {
+    return MapValue{std::make_shared<StaticClass<T, WithBases<Bases...>, Descriptors...>>(
+        std::move(descriptors)...)};
+  }
+
+  template <class T, class... Descriptors>
+  MapValue createStaticClass(Descriptors... descriptors) {
+    return createStaticClass<T>(WithBases<>(), std::move(descriptors)...);
+  }
+
+}  // namespace glue
@@ -2,8 +2,15 @@
 
 #include <glue/map.h>
 
+#include <cmath>
+#include <cstdint>
 #include <functional>
+#include <limits>
+#include <memory_resource>
 #include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
 #include <vector>
 
 namespace glue {
@@ -16,6 +23,7 @@ namespace glue {
   struct MapValue;
   struct MappedValue;
   struct FunctionValue;
+  class InlineValue;
 
   namespace detail {
     /**
@@ -28,17 +36,184 @@ namespace glue {
     template <class T> struct is_callable<T, void_t<has_opr_t<typename std::decay<T>::type>>>
         : std::true_type {};
 
+    template <class T> bool isTypeOf(const revisited::TypeID &type) {
+      using V = typename std::remove_reference<T>::type;
+      return type == revisited::getTypeID<V>()
+             || type == revisited::getTypeID<typename std::remove_cv<V>::type>();
+    }
+
+    template <class Signature> struct FunctionSignature;
+
+    template <class R, typename... Args> struct FunctionSignature<R(Args...)> {
+      using Return = R;
+
+      static bool matches(const AnyFunction &f) {
+        if (f.isVariadic() || f.argumentCount() != sizeof...(Args)) return false;
+        if (!isTypeOf<R>(f.returnType())) return false;
+        size_t i = 0;
+        return (isTypeOf<Args>(f.argumentType(i++)) && ...);
+      }
+    };
+
     template <class T> Any convertArgumentToAny(T &&arg) {
       if constexpr (is_callable<T>::value) {
         return Any::create<AnyFunction>(std::forward<T>(arg));
       } else if constexpr (std::is_base_of<ValueBase, typename std::decay<T>::type>::value) {
         return convertArgumentToAny(arg.data);
+      } else if constexpr (std::is_same<typename std::decay<T>::type, InlineValue>::value) {
+        return arg.toAny();
       } else {
         return Any(std::forward<T>(arg));
       }
     }
   }  // namespace detail
 
+  /**
+   * Stores booleans, arithmetic values and strings inline and all other values as `Any`.
+   * Integers and floating point numbers are widened to `int64_t` and `double`, unsigned integers
+   * that don't fit into `int64_t` are boxed. Numbers are only converted inline to types that
+   * represent them exactly, other conversions go through `Any`. Strings passed
+   * as lvalues or string views are referenced, not copied, so they must outlive the value,
+   * while temporary strings are boxed. Inline values are only boxed when `toAny` is called.
+   */
+  class InlineValue {
+  public:
+    InlineValue() = default;
+
+    template <class T, typename = typename std::enable_if<
+                           !std::is_same<typename std::decay<T>::type, InlineValue>::value>::type>
+    InlineValue(T &&value) {
+      using D = typename std::decay<T>::type;
+      if constexpr (std::is_same<D, bool>::value) {
+        data = value;
+      } else if constexpr (std::is_integral<D>::value) {
+        if constexpr (std::is_unsigned<D>::value && sizeof(D) >= sizeof(int64_t)) {
+          if (value > D(std::numeric_limits<int64_t>::max())) {
+            data = Any(D(value));
+            return;
+          }
+        }
+        data = int64_t(value);
+      } else if constexpr (std::is_floating_point<D>::value) {
+        data = double(value);
+      } else if constexpr (std::is_same<D, std::string_view>::value
+                           || std::is_same<D, const char *>::value
+                           || std::is_same<D, char *>::value) {
+        data = std::string_view(value);
+      } else if constexpr (std::is_same<D, std::string>::value
+                           && std::is_lvalue_reference<T>::value) {
+        data = std::string_view(value);
+      } else {
+        data = detail::convertArgumentToAny(std::forward<T>(value));
+      }
+    }
+
+    /**
+     * Returns `true` if the value is stored inline.
+     */
+    bool isInline() const { return data.index() != 0 && !std::holds_alternative<Any>(data); }
+
+    /**
+     * Returns `true` if `get<T>` can convert the value without boxing.
+     */
+    template <class T> bool convertsInline() const {
+      using D = typename std::decay<T>::type;
+      if constexpr (std::is_same<D, bool>::value) {
+        return std::holds_alternative<bool>(data);
+      } else if constexpr (std::is_arithmetic<D>::value) {
+        return convertsExactly<D>();
+      } else if constexpr (std::is_same<D, std::string_view>::value
+                           || (std::is_same<D, std::string>::value
+                               && !std::is_reference<T>::value)) {
+        return std::holds_alternative<std::string_view>(data);
+      } else {
+        return false;
+      }
+    }
+
+    /**
+     * Returns the value as `T`, converting inline values directly and boxed ones through `Any`.
+     * Throws if a reference is requested to an inline value that doesn't convert to it.
+     */
+    template <class T> T get() const {
+      using D = typename std::decay<T>::type;
+      if (auto any = std::get_if<Any>(&data)) {
+        return any->template get<T>();
+      }
+      if constexpr (std::is_arithmetic<D>::value && !std::is_reference<T>::value) {
+        if (auto b = std::get_if<bool>(&data)) return D(*b);
+        if (convertsExactly<D>()) {
+          if (auto i = std::get_if<int64_t>(&data)) return D(*i);
+          if (auto f = std::get_if<double>(&data)) return D(*f);
+        }
+      } else if constexpr ((std::is_same<D, std::string_view>::value
+                            || std::is_same<D, std::string>::value)
+                           && !std::is_reference<T>::value) {
+        if (auto s = std::get_if<std::string_view>(&data)) return D(*s);
+      }
+      if constexpr (std::is_reference<T>::value) {
+        throw std::runtime_error("cannot reference inline value");
+      } else {
+        return toAny().template get<T>();
+      }
+    }
+
+    /**
+     * Boxes the value, copying referenced strings.
+     */
+    Any toAny() const {
+      if (auto b = std::get_if<bool>(&data)) return Any(*b);
+      if (auto i = std::get_if<int64_t>(&data)) return Any(*i);
+      if (auto f = std::get_if<double>(&data)) return Any(*f);
+      if (auto s = std::get_if<std::string_view>(&data)) return Any(std::string(*s));
+      if (auto any = std::get_if<Any>(&data)) return *any;
+      return Any();
+    }
+
+    explicit operator bool() const {
+      return data.index() != 0 && (!std::holds_alternative<Any>(data) || std::get<Any>(data));
+    }
+
+  private:
+    std::variant<std::monostate, bool, int64_t, double, std::string_view, Any> data;
+
+    /**
+     * Returns `true` if the inline number is representable as `D` without loss.
+     */
+    template <class D> bool convertsExactly() const {
+      if (auto i = std::get_if<int64_t>(&data)) {
+        if constexpr (std::is_same<D, bool>::value) {
+          return false;
+        } else if constexpr (std::is_integral<D>::value) {
+          if constexpr (std::is_signed<D>::value) {
+            return *i >= int64_t(std::numeric_limits<D>::min())
+                   && *i <= int64_t(std::numeric_limits<D>::max());
+          } else {
+            return *i >= 0 && uint64_t(*i) <= uint64_t(std::numeric_limits<D>::max());
+          }
+        } else {
+          // the converted value is below 2^63, so converting it back is defined
+          auto converted = D(*i);
+          return converted < std::ldexp(D(1), 63) && int64_t(converted) == *i;
+        }
+      }
+      if (auto f = std::get_if<double>(&data)) {
+        if constexpr (std::is_same<D, bool>::value) {
+          return false;
+        } else if constexpr (std::is_integral<D>::value) {
+          // bounds are powers of two and therefore exact as doubles
+          auto limit = std::ldexp(1.0, std::numeric_limits<D>::digits);
+          auto lower = std::is_signed<D>::value ? -limit : 0.0;
+          return std::trunc(*f) == *f && *f >= lower && *f < limit;
+        } else {
+          if (!std::isfinite(*f)) return true;
+          return std::fabs(*f) <= double(std::numeric_limits<D>::max()) && double(D(*f)) == *f;
+        }
+      }
+      return false;
+    }
+  };
+
   struct Value : public ValueBase {
     Any data;
 
@@ -76,7 +251,27 @@ namespace glue {
     Value &operator=(const Value &) = default;
 
     // convenience access functions (throw exceptions when not applicable)
-    MappedValue operator[](const std::string &key) const;
+    MappedValue operator[](const Key &key) const;
+
+    /**
+     * Calls the stored function after checking that its signature matches `Signature`, e.g.
+     * `value.call<int(int, std::string)>(1, "x")`. Returns the result as the signature's return
+     * type.
+     */
+    template <class Signature, typename... Args> auto call(Args &&...args) const {
+      using R = typename detail::FunctionSignature<Signature>::Return;
+      auto f = asFunction();
+      if (!f) {
+        throw std::runtime_error("value is not a function");
+      }
+      if (!detail::FunctionSignature<Signature>::matches(f)) {
+        throw std::runtime_error("function signature mismatch");
+      }
+      auto result = f(detail::convertArgumentToAny(std::forward<Args>(args))...);
+      if constexpr (!std::is_void<R>::value) {
+        return result.template get<R>();
+      }
+    }
 
     template <typename... Args> Value operator()(Args &&...args) const {
       if (auto f = asFunction()) {
@@ -89,9 +284,9 @@ namespace glue {
 
   struct MappedValue : public Value {
     Map &parent;
-    std::string key;
+    Key key;
 
-    void set(const std::string &k, Any v);
+    void set(const Key &k, Any v);
 
     template <class T> MappedValue &operator=(T &&value) {
       set(key, detail::convertArgumentToAny(std::forward<T>(value)));
@@ -108,14 +303,33 @@ namespace glue {
     MapValue(std::shared_ptr<Map> d) : data(std::move(d)) {}
     MapValue &operator=(const MapValue &) = default;
 
-    Value get(const std::string &key) const;
-    Value rawGet(const std::string &key) const { return data->get(key); }
-    MappedValue operator[](const std::string &key) const {
+    /**
+     * Returns the value for the key, resolving undefined keys through the extends chain.
+     * Lookups through versioned maps are cached. Concurrent lookups are safe as long as no map
+     * along the chain is modified at the same time.
+     */
+    Value get(const Key &key) const;
+    Value rawGet(const Key &key) const { return data->get(key); }
+
+    /**
+     * Same as `get`, but bypasses the resolution cache, e.g. for one-off traversals that
+     * shouldn't populate it.
+     */
+    Value getUncached(const Key &key) const;
+
+    /**
+     * Same as `get`, but takes a dynamic name that is not interned, see `Key::find`.
+     */
+    Value find(std::string_view name) const {
+      if (auto key = Key::find(name)) return get(*key);
+      return Value();
+    }
+    MappedValue operator[](const Key &key) const {
       return MappedValue{{get(key)}, *data, key};
     }
     std::vector<std::string> keys() const;
     void forEach(const std::function<bool(const std::string &, Value)> &) const;
-    const MapValue &setValue(const std::string &key, Value value) const;
+    const MapValue &setValue(const Key &key, Value value) const;
 
     void setExtends(Value v) const;
 
@@ -128,4 +342,29 @@ namespace glue {
 
   MapValue createAnyMap();
 
+  /**
+   * Creates a map that allocates itself and its entry nodes from `resource`, which must outlive
+   * it. Only the map storage uses the resource: stored values, and the typed methods, field
+   * tables, class infos and functions created by `ClassGenerator`, are still allocated from the
+   * global heap.
+   */
+  MapValue createAnyMap(std::pmr::memory_resource *resource);
+
+  /**
+   * Creates a map with contiguous storage, best suited for small or rarely modified maps such
+   * as class maps.
+   */
+  MapValue createFlatMap();
+
+  /**
+   * Creates a flat map that allocates itself and its entry storage from `resource`, e.g. to be
+   * passed to `createClass`. As with `createAnyMap`, stored values are allocated separately.
+   */
+  MapValue createFlatMap(std::pmr::memory_resource *resource);
+
+  /**
+   * Creates a thread-safe map with wait-free readers, see `ConcurrentAnyMap`.
+   */
+  MapValue createConcurrentMap();
+
 }  // namespace glue
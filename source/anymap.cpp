@@ -3,7 +3,7 @@
 
 using namespace glue;
 
-Any AnyMap::get(const std::string &key) const {
+Any AnyMap::get(const Key &key) const {
   if (auto it = easy_iterator::find(data, key)) {
     return it->second;
   } else {
@@ -11,11 +11,14 @@ Any AnyMap::get(const std::string &key) const {
   }
 }
 
-void AnyMap::set(const std::string &key, const Any &value) { data[key] = value; }
+void AnyMap::set(const Key &key, const Any &value) {
+  data[key] = value;
+  ++currentVersion;
+}
 
 bool AnyMap::forEach(const std::function<bool(const std::string &)> &callback) const {
   for (auto &&v : data) {
-    if (callback(v.first)) return true;
+    if (callback(v.first.str())) return true;
   }
   return false;
 }
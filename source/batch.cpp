@@ -0,0 +1,79 @@
+#include <glue/batch.h>
+
+#include <algorithm>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+using namespace glue;
+
+namespace {
+
+  void invokeRange(const Instance *instances, const AnyFunction *const *functions, size_t begin,
+                   size_t end, const AnyArguments &arguments, Any *results) {
+    // the arguments share their boxed values with all other calls, see `invokeAll`
+    AnyArguments callArguments(arguments.size() + 1);
+    std::copy(arguments.begin(), arguments.end(), callArguments.begin() + 1);
+    for (size_t i = begin; i < end; ++i) {
+      callArguments[0] = *instances[i];
+      auto result = functions[i]->call(callArguments);
+      if (results) results[i] = std::move(result);
+    }
+  }
+
+}  // namespace
+
+void glue::invokeAll(const Instance *instances, size_t count, const Key &key,
+                     const AnyArguments &arguments, Any *results, const InvokeOptions &options) {
+  // instances of the same class are usually adjacent, so remember the last class map
+  std::unordered_map<const Map *, AnyFunction> methods;
+  std::vector<const AnyFunction *> functions(count);
+  const Map *lastClass = nullptr;
+  const AnyFunction *lastFunction = nullptr;
+  for (size_t i = 0; i < count; ++i) {
+    auto &instance = instances[i];
+    if (!instance) {
+      throw std::runtime_error("called method on undefined instance");
+    }
+    auto classMap = instance.classMap.data.get();
+    if (classMap != lastClass) {
+      auto it = methods.find(classMap);
+      if (it == methods.end()) {
+        auto function = instance.classMap.get(key).asFunction();
+        if (!function) {
+          throw std::runtime_error("instance has no method " + key.str());
+        }
+        it = methods.emplace(classMap, std::move(function)).first;
+      }
+      lastClass = classMap;
+      lastFunction = &it->second;
+    }
+    functions[i] = lastFunction;
+  }
+
+  auto chunks = std::min(std::max<size_t>(options.threads, 1),
+                         count / std::max<size_t>(options.minChunkSize, 1));
+  if (chunks <= 1) {
+    invokeRange(instances, functions.data(), 0, count, arguments, results);
+    return;
+  }
+
+  std::exception_ptr error;
+  std::mutex errorMutex;
+  std::vector<std::thread> threads;
+  threads.reserve(chunks);
+  for (size_t c = 0; c < chunks; ++c) {
+    auto begin = count * c / chunks, end = count * (c + 1) / chunks;
+    threads.emplace_back([&, begin, end]() {
+      try {
+        invokeRange(instances, functions.data(), begin, end, arguments, results);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (!error) error = std::current_exception();
+      }
+    });
+  }
+  for (auto &thread : threads) thread.join();
+  if (error) std::rethrow_exception(error);
+}
@@ -0,0 +1,71 @@
+#include <glue/concurrent_anymap.h>
+
+#include <thread>
+
+using namespace glue;
+
+class ConcurrentAnyMap::ReadGuard {
+private:
+  std::atomic<size_t> &counter;
+
+public:
+  const Data *data;
+
+  explicit ReadGuard(const ConcurrentAnyMap &map)
+      : counter(map.readers[map.epoch.load() & 1]), data(nullptr) {
+    // the counter must be incremented before the snapshot is loaded
+    counter.fetch_add(1);
+    data = map.current.load();
+  }
+
+  ~ReadGuard() { counter.fetch_sub(1); }
+};
+
+ConcurrentAnyMap::ConcurrentAnyMap() : current(new Data()) {
+  readers[0] = 0;
+  readers[1] = 0;
+}
+
+ConcurrentAnyMap::~ConcurrentAnyMap() { delete current.load(); }
+
+void ConcurrentAnyMap::waitForReaders(size_t parity) const {
+  while (readers[parity].load() != 0) {
+    std::this_thread::yield();
+  }
+}
+
+Any ConcurrentAnyMap::get(const Key &key) const {
+  ReadGuard guard(*this);
+  auto it = guard.data->find(key);
+  if (it != guard.data->end()) {
+    return it->second;
+  } else {
+    return Any();
+  }
+}
+
+void ConcurrentAnyMap::set(const Key &key, const Any &value) {
+  std::lock_guard<std::mutex> lock(writeMutex);
+  auto previous = current.load();
+  auto next = new Data(*previous);
+  (*next)[key] = value;
+  current.store(next);
+  // readers may have registered with either counter before the new snapshot was published,
+  // so both counters must drain once before the previous snapshot can be released
+  waitForReaders(epoch.fetch_add(1) & 1);
+  waitForReaders(epoch.fetch_add(1) & 1);
+  delete previous;
+}
+
+bool ConcurrentAnyMap::forEach(const std::function<bool(const std::string &)> &callback) const {
+  ReadGuard guard(*this);
+  for (auto &&v : *guard.data) {
+    if (callback(v.first.str())) return true;
+  }
+  return false;
+}
+
+size_t ConcurrentAnyMap::size() const {
+  ReadGuard guard(*this);
+  return guard.data->size();
+}
@@ -1,43 +1,357 @@
-#include <easy_iterator.h>
 #include <glue/class.h>
 #include <glue/context.h>
+#include <glue/lazy_map.h>
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
 
 using namespace glue;
 
-void Context::addMap(const MapValue &map, std::vector<std::string> &path) {
-  if (auto info = getClassInfo(map)) {
-    TypeInfo typeInfo;
-    typeInfo.classInfo = info;
-    typeInfo.path = path;
-    typeInfo.data = map;
-    uniqueTypes.push_back(info->typeID);
-    types[info->typeID.index] = typeInfo;
-    types[info->constTypeID.index] = typeInfo;
-    types[info->sharedTypeID.index] = typeInfo;
-    types[info->sharedConstTypeID.index] = typeInfo;
-  } else {
-    map.forEach([&](auto &&key, auto &&value) {
-      if (auto m = value.asMap()) {
+namespace {
+
+  /**
+   * Calls `onClass` with each class map and its info in the tree below `map` and `onLazy` with
+   * each unmaterialized `LazyMap` entry, keeping `path` at the path of the current entry.
+   */
+  template <class OnClass, class OnLazy>
+  void visitClasses(const MapValue &map, Context::Path &path, const OnClass &onClass,
+                    const OnLazy &onLazy) {
+    if (auto info = getClassInfo(map)) {
+      onClass(map, info);
+    } else if (auto lazy = std::dynamic_pointer_cast<LazyMap>(map.data)) {
+      // defer unmaterialized entries until a lookup misses
+      lazy->forEach([&](auto &&key) {
         path.push_back(key);
-        addMap(m, path);
+        if (lazy->isMaterialized(key)) {
+          if (auto m = Value(lazy->get(key)).asMap()) visitClasses(m, path, onClass, onLazy);
+        } else {
+          onLazy(lazy, Key(key));
+        }
         path.pop_back();
-      }
-      return false;
-    });
+        return false;
+      });
+    } else {
+      map.forEach([&](auto &&key, auto &&value) {
+        if (auto m = value.asMap()) {
+          path.push_back(key);
+          visitClasses(m, path, onClass, onLazy);
+          path.pop_back();
+        }
+        return false;
+      });
+    }
+  }
+
+}  // namespace
+
+Context::Context(const Context &other) { *this = other; }
+
+Context &Context::operator=(const Context &other) {
+  if (this == &other) return *this;
+  types = other.types;
+  uniqueTypes = other.uniqueTypes;
+  modules = other.modules;
+  registrations = other.registrations;
+  // registrations refer to modules by the address of their key
+  auto remap = [&](const Path *module) {
+    return module ? &modules.find(*module)->first : nullptr;
+  };
+  for (auto &&registration : registrations) {
+    registration.owner = remap(registration.owner);
+    for (auto &&shadowed : registration.shadowed) shadowed.first = remap(shadowed.first);
+  }
+  std::lock_guard<std::mutex> guard(other.lazy.mutex);
+  lazy.pending = other.lazy.pending;
+  lazy.resolved = other.lazy.resolved;
+  lazy.index = other.lazy.index;
+  for (auto &&entry : lazy.pending) entry.module = remap(entry.module);
+  for (auto &&resolved : lazy.resolved) resolved.second = remap(resolved.second);
+  hasLazyTypes = other.hasLazyTypes;
+  return *this;
+}
+
+void Context::TypeTable::insertIndex(TypeIndex type, uint32_t info) {
+  auto mask = index.size() - 1;
+  for (auto slot = std::hash<TypeIndex>()(type) & mask;; slot = (slot + 1) & mask) {
+    if (index[slot].info == 0) {
+      index[slot] = Slot{type, info + 1};
+      indexSize++;
+      return;
+    } else if (index[slot].type == type) {
+      index[slot].info = info + 1;
+      return;
+    }
+  }
+}
+
+void Context::TypeTable::rebuildIndex(size_t capacity) {
+  index.assign(capacity, Slot{getTypeIndex<void>(), 0});
+  indexSize = 0;
+  for (uint32_t i = 0; i < entries.size(); ++i) {
+    if (!entries[i].classInfo) continue;
+    auto &classInfo = *entries[i].classInfo;
+    insertIndex(classInfo.typeID.index, i);
+    insertIndex(classInfo.constTypeID.index, i);
+    insertIndex(classInfo.sharedTypeID.index, i);
+    insertIndex(classInfo.sharedConstTypeID.index, i);
+  }
+}
+
+void Context::TypeTable::eraseIndex(TypeIndex type) {
+  auto mask = index.size() - 1;
+  auto slot = std::hash<TypeIndex>()(type) & mask;
+  for (;; slot = (slot + 1) & mask) {
+    if (index[slot].info == 0) return;
+    if (index[slot].type == type) break;
+  }
+  index[slot].info = 0;
+  indexSize--;
+  // shift back following entries that would otherwise become unreachable
+  for (auto next = (slot + 1) & mask; index[next].info != 0; next = (next + 1) & mask) {
+    auto ideal = std::hash<TypeIndex>()(index[next].type) & mask;
+    bool reachable
+        = slot <= next ? (slot < ideal && ideal <= next) : (slot < ideal || ideal <= next);
+    if (!reachable) {
+      index[slot] = index[next];
+      index[next].info = 0;
+      slot = next;
+    }
+  }
+}
+
+size_t Context::TypeTable::slotOf(TypeIndex type) const {
+  if (index.empty()) return index.size();
+  auto mask = index.size() - 1;
+  for (auto slot = std::hash<TypeIndex>()(type) & mask;; slot = (slot + 1) & mask) {
+    auto &entry = index[slot];
+    if (entry.info == 0) return index.size();
+    if (entry.type == type) return slot;
+  }
+}
+
+const Context::TypeInfo *Context::TypeTable::get(TypeIndex type) const {
+  auto slot = slotOf(type);
+  return slot < index.size() ? &entries[index[slot].info - 1] : nullptr;
+}
+
+Context::TypeTable::const_iterator Context::TypeTable::find(TypeIndex type) const {
+  auto slot = slotOf(type);
+  return slot < index.size() ? const_iterator(this, slot) : end();
+}
+
+const Context::TypeInfo &Context::TypeTable::at(TypeIndex type) const {
+  if (auto info = get(type)) return *info;
+  throw std::out_of_range("type is not registered");
+}
+
+uint32_t Context::TypeTable::insert(TypeInfo typeInfo) {
+  auto &info = *typeInfo.classInfo;
+  uint32_t i;
+  if (freeEntries.empty()) {
+    i = uint32_t(entries.size());
+    entries.push_back(std::move(typeInfo));
+  } else {
+    i = freeEntries.back();
+    freeEntries.pop_back();
+    entries[i] = std::move(typeInfo);
+  }
+  // keep the load factor at or below 1/2
+  if (index.size() < (indexSize + 4) * 2) {
+    size_t capacity = 64;
+    while (capacity < (indexSize + 4) * 2) capacity *= 2;
+    rebuildIndex(capacity);
+  } else {
+    insertIndex(info.typeID.index, i);
+    insertIndex(info.constTypeID.index, i);
+    insertIndex(info.sharedTypeID.index, i);
+    insertIndex(info.sharedConstTypeID.index, i);
+  }
+  return i;
+}
+
+void Context::TypeTable::erase(uint32_t position) {
+  auto &info = *entries[position].classInfo;
+  eraseIndex(info.typeID.index);
+  eraseIndex(info.constTypeID.index);
+  eraseIndex(info.sharedTypeID.index);
+  eraseIndex(info.sharedConstTypeID.index);
+  entries[position] = TypeInfo();
+  freeEntries.push_back(position);
+}
+
+void Context::addType(TypeInfo typeInfo, const Path *owner) {
+  auto &typeID = typeInfo.classInfo->typeID;
+  auto existing = types.get(typeID.index);
+  if (!existing) {
+    auto i = types.insert(std::move(typeInfo));
+    if (i == registrations.size()) registrations.emplace_back();
+    registrations[i] = Registrations{owner, {}};
+    uniqueTypes.push_back(typeID);
+    if (owner) modules[*owner].push_back(typeID.index);
+    return;
+  }
+  // classes registered multiple times are replaced, earlier registrations of other owners are
+  // restored when the replacing module is removed
+  auto i = types.positionOf(existing);
+  auto &entry = types.entries[i];
+  auto &registration = registrations[i];
+  if (registration.owner != owner) {
+    auto &shadowed = registration.shadowed;
+    auto previous = std::find_if(shadowed.begin(), shadowed.end(),
+                                 [&](auto &&other) { return other.first == owner; });
+    if (previous != shadowed.end()) {
+      shadowed.erase(previous);
+    } else if (owner) {
+      modules[*owner].push_back(typeID.index);
+    }
+    shadowed.emplace_back(registration.owner, std::move(entry));
+    registration.owner = owner;
+  }
+  entry = std::move(typeInfo);
+}
+
+bool Context::removeType(TypeIndex type, const Path *owner) {
+  auto existing = types.get(type);
+  if (!existing) return false;
+  auto i = types.positionOf(existing);
+  auto &registration = registrations[i];
+  auto &shadowed = registration.shadowed;
+  if (registration.owner != owner) {
+    shadowed.erase(std::remove_if(shadowed.begin(), shadowed.end(),
+                                  [&](auto &&other) { return other.first == owner; }),
+                   shadowed.end());
+    return false;
+  }
+  if (shadowed.empty()) {
+    types.erase(i);
+    registration = Registrations();
+    return true;
+  }
+  // fall back to the most recent registration of another module or root map
+  registration.owner = shadowed.back().first;
+  types.entries[i] = std::move(shadowed.back().second);
+  shadowed.pop_back();
+  return false;
+}
+
+void Context::addMap(const MapValue &map, Path &path, const Path *module) {
+  visitClasses(
+      map, path,
+      [&](const MapValue &classMap, const auto &info) {
+        addType(TypeInfo{classMap, path, info}, module);
+      },
+      [&](const auto &lazyMap, const auto &key) {
+        lazy.pending.push_back(LazyEntry{lazyMap, key, path, module, lazyMap->getClassHint(key)});
+        hasLazyTypes = true;
+      });
+}
+
+const Context::TypeInfo *Context::resolveLazyType(TypeIndex type) const {
+  std::lock_guard<std::mutex> guard(lazy.mutex);
+  auto mayCreate = [&](const LazyEntry &entry) {
+    auto hint = entry.hint;
+    return !hint || hint->typeID.index == type || hint->constTypeID.index == type
+           || hint->sharedTypeID.index == type || hint->sharedConstTypeID.index == type;
+  };
+  while (true) {
+    if (auto it = lazy.index.find(type); it != lazy.index.end()) {
+      return &lazy.resolved[it->second].first;
+    }
+    auto entry = std::find_if(lazy.pending.begin(), lazy.pending.end(), mayCreate);
+    if (entry == lazy.pending.end()) return nullptr;
+    // keep the entry pending if the factory throws
+    Value value = entry->map->get(entry->key);
+    auto resolved = std::move(*entry);
+    lazy.pending.erase(entry);
+    auto map = value.asMap();
+    if (!map) continue;
+    visitClasses(
+        map, resolved.path,
+        [&](const MapValue &classMap, const auto &info) {
+          // classes found by lookups don't replace registered ones
+          if (types.get(info->typeID.index) || lazy.index.count(info->typeID.index)) return;
+          auto position = lazy.resolved.size();
+          lazy.resolved.emplace_back(TypeInfo{classMap, resolved.path, info}, resolved.module);
+          for (auto &&typeID : {info->typeID, info->constTypeID, info->sharedTypeID,
+                                info->sharedConstTypeID}) {
+            lazy.index[typeID.index] = position;
+          }
+        },
+        [&](const auto &lazyMap, const auto &key) {
+          lazy.pending.push_back(LazyEntry{lazyMap, key, resolved.path, resolved.module,
+                                           lazyMap->getClassHint(key)});
+        });
   }
 }
 
+void Context::addLazyTypes() {
+  if (!hasLazyTypes) return;
+  for (auto &&[typeInfo, module] : lazy.resolved) {
+    addType(std::move(typeInfo), module);
+  }
+  lazy.resolved.clear();
+  lazy.index.clear();
+  hasLazyTypes = !lazy.pending.empty();
+}
+
+void Context::resolveLazyEntries() {
+  addLazyTypes();
+  while (!lazy.pending.empty()) {
+    // keep the entry pending if the factory throws
+    Value value = lazy.pending.back().map->get(lazy.pending.back().key);
+    auto entry = std::move(lazy.pending.back());
+    lazy.pending.pop_back();
+    if (auto m = value.asMap()) addMap(m, entry.path, entry.module);
+  }
+  hasLazyTypes = false;
+}
+
+void Context::addMap(const MapValue &map, Path &path) {
+  addLazyTypes();
+  addMap(map, path, nullptr);
+}
+
 void Context::addRootMap(const MapValue &map) {
   Path path;
   addMap(map, path);
 }
 
-const Context::TypeInfo *Context::getTypeInfo(TypeIndex type) const {
-  if (auto it = easy_iterator::find(types, type)) {
-    return &it->second;
-  } else {
-    return nullptr;
+void Context::addModule(const Path &path, const MapValue &map) {
+  removeModule(path);
+  // list the module even if it registers no classes
+  auto module = &modules.emplace(path, std::vector<TypeIndex>()).first->first;
+  Path modulePath = path;
+  addMap(map, modulePath, module);
+}
+
+bool Context::removeModule(const Path &path) {
+  addLazyTypes();
+  auto it = modules.find(path);
+  if (it == modules.end()) return false;
+  auto module = &it->first;
+  auto &pending = lazy.pending;
+  pending.erase(std::remove_if(pending.begin(), pending.end(),
+                               [&](auto &&entry) { return entry.module == module; }),
+                pending.end());
+  hasLazyTypes = !pending.empty();
+  bool removed = false;
+  for (auto &&type : it->second) {
+    removed |= removeType(type, module);
   }
+  modules.erase(it);
+  if (removed) {
+    // a single pass keeps the registration order of the remaining classes
+    uniqueTypes.erase(std::remove_if(uniqueTypes.begin(), uniqueTypes.end(),
+                                     [&](auto &&typeID) { return !types.get(typeID.index); }),
+                      uniqueTypes.end());
+  }
+  return true;
+}
+
+const Context::TypeInfo *Context::getTypeInfo(TypeIndex type) const {
+  if (auto info = types.get(type)) return info;
+  return hasLazyTypes ? resolveLazyType(type) : nullptr;
 }
 
 Instance Context::createInstance(Value value) const {
@@ -1,17 +1,224 @@
 #include <easy_iterator.h>
 #include <glue/declarations.h>
 #include <glue/keys.h>
+#include <glue/profiling.h>
 
 #include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <sstream>
 #include <string>
+#include <thread>
 
 using namespace glue;
 
+namespace {
+
+  struct PrintedEntry {
+    std::string name;
+    Value value;
+    uint64_t hash = 0;
+    bool printed = false;
+    std::string text;
+    /**
+     * The cached text, if the entry is unchanged. It is only moved out of the cache once the
+     * whole print has succeeded.
+     */
+    std::string *cachedText = nullptr;
+    bool needsBreak = false;
+
+    const std::string &getText() const { return cachedText ? *cachedText : text; }
+  };
+
+  /**
+   * 64-bit FNV-1a
+   */
+  struct Hasher {
+    uint64_t value = 14695981039346656037ull;
+
+    void add(const char *data, size_t size) {
+      for (size_t i = 0; i < size; ++i) {
+        value ^= uint8_t(data[i]);
+        value *= 1099511628211ull;
+      }
+    }
+
+    void add(const std::string &string) {
+      add(string.data(), string.size());
+      // separate consecutive strings
+      add(uint64_t(string.size()));
+    }
+
+    void add(uint64_t number) { add(reinterpret_cast<const char *>(&number), sizeof(number)); }
+  };
+
+  /**
+   * Prints the top-level entries into separate buffers, optionally in parallel and reusing
+   * cached text, and joins them in the same way as `printInnerBlock`.
+   * Each thread uses its own state, as type names don't depend on the printing order.
+   */
+  void printTopLevel(const DeclarationPrinter &printer, std::ostream &stream,
+                     const MapValue &value, Context *context, DeclarationCache *cache) {
+    auto keys = value.keys();
+    std::sort(keys.begin(), keys.end());
+    std::vector<PrintedEntry> entries(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+      entries[i].name = keys[i];
+      entries[i].value = value.rawGet(keys[i]);
+    }
+
+    std::atomic<size_t> next{0};
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    auto work = [&]() {
+      DeclarationPrinter::State local;
+      local.context = context;
+      try {
+        for (size_t i = next++; i < entries.size(); i = next++) {
+          auto &entry = entries[i];
+          if (cache) {
+            entry.hash = printer.hashEntry(entry.name, entry.value, local);
+            auto cached = cache->entries.find(entry.name);
+            if (cached != cache->entries.end() && cached->second.hash == entry.hash) {
+              entry.cachedText = &cached->second.text;
+              entry.needsBreak = cached->second.needsBreak;
+              continue;
+            }
+          }
+          std::ostringstream entryStream;
+          entry.needsBreak = printer.printEntry(entryStream, entry.name, entry.value, local);
+          entry.text = entryStream.str();
+          entry.printed = true;
+        }
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (!error) error = std::current_exception();
+        next = entries.size();
+      }
+    };
+    auto threads = std::min(printer.threads, entries.size());
+    if (threads <= 1) {
+      work();
+    } else {
+      std::vector<std::thread> workers;
+      for (size_t i = 0; i < threads; ++i) workers.emplace_back(work);
+      for (auto &worker : workers) worker.join();
+    }
+    if (error) std::rethrow_exception(error);
+
+    DeclarationPrinter::State state;
+    state.context = context;
+    bool initial = true;
+    bool needsBreak = true;
+    for (auto &entry : entries) {
+      if (initial) {
+        initial = false;
+        printer.printIndent(stream, state);
+      } else if (needsBreak) {
+        stream << '\n';
+        printer.printIndent(stream, state);
+      }
+      stream << entry.getText();
+      needsBreak = entry.needsBreak;
+    }
+
+    if (cache) {
+      // build the new cache separately, as unchanged entries move their text out of the old one
+      decltype(cache->entries) rebuilt;
+      size_t reprinted = 0;
+      for (auto &entry : entries) {
+        if (entry.printed) ++reprinted;
+        auto &text = entry.cachedText ? *entry.cachedText : entry.text;
+        rebuilt[entry.name]
+            = DeclarationCache::Entry{entry.hash, entry.needsBreak, std::move(text)};
+      }
+      cache->entries = std::move(rebuilt);
+      cache->reprinted = reprinted;
+    }
+  }
+
+}  // namespace
+
 void DeclarationPrinter::print(std::ostream &stream, const MapValue &value,
                                Context *context) const {
-  State state;
-  state.context = context;
-  printInnerBlock(stream, value, state);
+  // profiled maps hide function signatures
+  auto root = unwrapProfiling(value);
+  if (threads <= 1) {
+    State state;
+    state.context = context;
+    printInnerBlock(stream, root, state);
+  } else {
+    printTopLevel(*this, stream, root, context, nullptr);
+  }
+}
+
+void DeclarationPrinter::print(std::ostream &stream, const MapValue &value, Context *context,
+                               DeclarationCache &cache) const {
+  printTopLevel(*this, stream, unwrapProfiling(value), context, &cache);
+}
+
+uint64_t DeclarationPrinter::hashEntry(const std::string &name, const Value &value,
+                                       State &state) const {
+  Hasher hasher;
+  auto addTypeName = [&](const TypeID &type) {
+    // avoid a stream for names already cached by `printTypeName`
+    if (auto name = easy_iterator::find(state.typeNames, type.index)) {
+      hasher.add(name->second);
+    } else if (auto internalName = easy_iterator::find(internalTypeNames, type.index)) {
+      hasher.add(internalName->second);
+    } else {
+      std::ostringstream stream;
+      printTypeName(stream, type, state);
+      hasher.add(stream.str());
+    }
+  };
+
+  hasher.add(name);
+  hasher.add(uint64_t(state.depth));
+  if (auto keyPrinter = easy_iterator::find(keyPrinters, name)) {
+    // key printers may print anything, so hash their output
+    std::ostringstream stream;
+    hasher.add(uint64_t(keyPrinter->second(stream, name, value, state)));
+    hasher.add(stream.str());
+  } else if (auto map = value.asMap()) {
+    auto classInfo = map.getUncached(keys::classKey);
+    auto previousClass = state.currentClass;
+    if (classInfo) {
+      auto info = classInfo->get<ClassInfo>();
+      state.currentClass = info;
+      addTypeName(info.typeID);
+      hasher.add(info.typeID.name);
+      hasher.add(uint64_t(info.typeID.index));
+      hasher.add(uint64_t(bool(map.getUncached(keys::constructorKey))));
+      if (auto extends = map.getUncached(keys::extendsKey).asMap()) {
+        if (auto extendedClass = extends.getUncached(keys::classKey)) {
+          addTypeName(extendedClass->get<ClassInfo>().typeID);
+        }
+      }
+    }
+    auto keys = map.keys();
+    std::sort(keys.begin(), keys.end());
+    state.depth++;
+    for (auto &key : keys) {
+      hasher.add(hashEntry(key, map.rawGet(key), state));
+    }
+    state.depth--;
+    state.currentClass = previousClass;
+  } else if (auto f = value.asFunction()) {
+    hasher.add(uint64_t(f.isVariadic()));
+    if (!f.isVariadic()) {
+      hasher.add(uint64_t(f.argumentCount()));
+      for (size_t i = 0; i < f.argumentCount(); ++i) {
+        hasher.add(uint64_t(f.argumentType(i).index));
+        addTypeName(f.argumentType(i));
+      }
+    }
+    addTypeName(f.returnType());
+  } else {
+    addTypeName(value->type());
+  }
+  return hasher.value;
 }
 
 void DeclarationPrinter::printValue(std::ostream &stream, const std::string &name,
@@ -81,12 +288,14 @@ void DeclarationPrinter::printFunction(std::ostream &stream, const std::string &
 void DeclarationPrinter::printMemberFunction(std::ostream &stream, const std::string &name,
                                              const AnyFunction &f, State &state) const {
   auto N = f.argumentCount();
+  // methods may also take the instance as `Any`, e.g. to share its ownership
   bool isStatic = (!f.isVariadic())
                   && (N == 0
                       || (f.argumentType(0) != state.currentClass->typeID
                           && f.argumentType(0) != state.currentClass->constTypeID
                           && f.argumentType(0) != state.currentClass->sharedTypeID
-                          && f.argumentType(0) != state.currentClass->sharedConstTypeID));
+                          && f.argumentType(0) != state.currentClass->sharedConstTypeID
+                          && f.argumentType(0) != getTypeID<Any>()));
   bool initial = true;
   if (isStatic) {
     stream << "static " << name;
@@ -151,8 +360,8 @@ void DeclarationPrinter::printMap(std::ostream &stream, const std::string &name,
 
 void DeclarationPrinter::printClassMap(std::ostream &stream, const std::string &name,
                                        const MapValue &value, State &state) const {
-  auto classInfo = value[keys::classKey]->get<ClassInfo>();
-  if (value[keys::constructorKey]) {
+  auto classInfo = value.getUncached(keys::classKey)->get<ClassInfo>();
+  if (value.getUncached(keys::constructorKey)) {
     stream << "/** @customConstructor ";
     printTypeName(stream, classInfo.typeID, state);
     stream << ".__new"
@@ -164,9 +373,9 @@ void DeclarationPrinter::printClassMap(std::ostream &stream, const std::string &
     stream << "declare ";
   }
   stream << "class " << name;
-  if (auto extends = value[keys::extendsKey]) {
-    if (auto extendedMap = Value(*extends).asMap()) {
-      if (auto extendedMapClass = extendedMap[keys::classKey]) {
+  if (auto extends = value.getUncached(keys::extendsKey)) {
+    if (auto extendedMap = extends.asMap()) {
+      if (auto extendedMapClass = extendedMap.getUncached(keys::classKey)) {
         stream << " extends ";
         printTypeName(stream, extendedMapClass->get<ClassInfo>().typeID, state);
       }
@@ -195,7 +404,6 @@ void DeclarationPrinter::printInnerBlock(std::ostream &stream, const MapValue &v
   std::sort(keys.begin(), keys.end());
 
   for (auto &&k : keys) {
-    auto v = value[k];
     if (initial) {
       initial = false;
       printIndent(stream, state);
@@ -203,33 +411,37 @@ void DeclarationPrinter::printInnerBlock(std::ostream &stream, const MapValue &v
       stream << '\n';
       printIndent(stream, state);
     }
-    if (auto keyPrinter = easy_iterator::find(keyPrinters, k)) {
-      needsBreak = keyPrinter->second(stream, k, v, state);
+    needsBreak = printEntry(stream, k, value.rawGet(k), state);
+  }
+}
+
+bool DeclarationPrinter::printEntry(std::ostream &stream, const std::string &k, const Value &v,
+                                    State &state) const {
+  if (auto keyPrinter = easy_iterator::find(keyPrinters, k)) {
+    return keyPrinter->second(stream, k, v, state);
+  }
+  if (auto m = v.asMap()) {
+    if (auto classInfo = m.getUncached(keys::classKey)) {
+      state.currentClass = classInfo->template get<ClassInfo>();
+      printClassMap(stream, k, m, state);
+      state.currentClass = std::nullopt;
     } else {
-      if (auto m = v.asMap()) {
-        if (auto classInfo = m[keys::classKey]) {
-          state.currentClass = classInfo->template get<ClassInfo>();
-          printClassMap(stream, k, m, state);
-          state.currentClass = std::nullopt;
-        } else {
-          printMap(stream, k, m, state);
-        }
-      } else if (auto f = v.asFunction()) {
-        if (state.currentClass) {
-          if (k == keys::constructorKey) {
-            printConstructor(stream, f, state);
-          } else {
-            printMemberFunction(stream, k, f, state);
-          }
-        } else {
-          printFunction(stream, k, f, state);
-        }
+      printMap(stream, k, m, state);
+    }
+  } else if (auto f = v.asFunction()) {
+    if (state.currentClass) {
+      if (k == keys::constructorKey) {
+        printConstructor(stream, f, state);
       } else {
-        printValue(stream, k, v, state);
+        printMemberFunction(stream, k, f, state);
       }
-      needsBreak = true;
+    } else {
+      printFunction(stream, k, f, state);
     }
-  };
+  } else {
+    printValue(stream, k, v, state);
+  }
+  return true;
 }
 
 namespace {
@@ -258,4 +470,76 @@ void DeclarationPrinter::init() {
 
   keyPrinters[keys::classKey] = [](auto &&, auto &&, auto &&, auto &&) { return false; };
   keyPrinters[keys::extendsKey] = [](auto &&, auto &&, auto &&, auto &&) { return false; };
+  keyPrinters[keys::typedMethodsKey] = [](auto &&, auto &&, auto &&, auto &&) { return false; };
+  keyPrinters[keys::fieldsKey] = [](auto &&, auto &&, auto &&, auto &&) { return false; };
+}
+
+namespace {
+  const char *cacheHeader = "glue declaration cache 1";
+}
+
+void DeclarationCache::save(std::ostream &stream) const {
+  stream << cacheHeader << '\n' << entries.size() << '\n';
+  for (auto &&entry : entries) {
+    stream << entry.first.size() << ' ' << entry.first << ' ' << entry.second.hash << ' '
+           << entry.second.needsBreak << ' ' << entry.second.text.size() << ' '
+           << entry.second.text << '\n';
+  }
+}
+
+bool DeclarationCache::load(std::istream &stream) {
+  entries.clear();
+  std::string header;
+  size_t count = 0;
+  if (!std::getline(stream, header) || header != cacheHeader || !(stream >> count)) {
+    return false;
+  }
+  // sizes are checked against the remaining length of seekable streams and strings are read in
+  // chunks otherwise, so corrupt sizes can't cause huge allocations
+  std::istream::pos_type end = -1;
+  auto start = stream.tellg();
+  if (start != std::istream::pos_type(-1) && stream.seekg(0, std::ios::end)) {
+    end = stream.tellg();
+    stream.seekg(start);
+  }
+  stream.clear();
+  auto readString = [&](std::string &string) {
+    size_t size;
+    if (!(stream >> size) || stream.get() != ' ') return false;
+    if (end != std::istream::pos_type(-1)) {
+      auto position = stream.tellg();
+      if (position == std::istream::pos_type(-1) || size > size_t(end - position)) return false;
+    }
+    string.clear();
+    while (string.size() < size) {
+      auto offset = string.size();
+      string.resize(offset + std::min(size - offset, size_t(1) << 16));
+      if (!stream.read(&string[offset], std::streamsize(string.size() - offset))) return false;
+    }
+    return true;
+  };
+  for (size_t i = 0; i < count; ++i) {
+    std::string name;
+    Entry entry;
+    if (!readString(name) || !(stream >> entry.hash >> entry.needsBreak) || stream.get() != ' '
+        || !readString(entry.text)) {
+      entries.clear();
+      return false;
+    }
+    entries[name] = std::move(entry);
+  }
+  return true;
+}
+
+bool DeclarationCache::loadFile(const std::string &path) {
+  std::ifstream stream(path, std::ios::binary);
+  return stream && load(stream);
+}
+
+void DeclarationCache::saveFile(const std::string &path) const {
+  std::ofstream stream(path, std::ios::binary);
+  save(stream);
+  if (!stream) {
+    throw std::runtime_error("cannot write declaration cache " + path);
+  }
 }
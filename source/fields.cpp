@@ -0,0 +1,69 @@
+#include <glue/fields.h>
+
+#include <algorithm>
+
+using namespace glue;
+
+void FieldTable::erase(const Key &name) {
+  fields.erase(std::remove_if(fields.begin(), fields.end(),
+                              [&](auto &field) { return field.name == name; }),
+               fields.end());
+}
+
+namespace {
+
+  const FieldTable &getInstanceFieldTable(const Instance &instance) {
+    if (!instance) {
+      throw std::runtime_error("undefined instance");
+    }
+    auto table = instance.classMap.rawGet(keys::fieldsKey)->getShared<const FieldTable>();
+    if (!table) {
+      throw std::runtime_error("class has no fields");
+    }
+    return *table;
+  }
+
+  const FieldDescriptor &getField(const FieldTable &table, const Key &name) {
+    auto field = table.find(name);
+    if (!field) {
+      throw std::runtime_error("unknown field " + name.str());
+    }
+    return *field;
+  }
+
+}  // namespace
+
+void glue::readFields(const Instance &instance, const std::vector<Key> &fields, void *buffer) {
+  auto &table = getInstanceFieldTable(instance);
+  auto object = static_cast<const char *>(table.getConstObject(*instance));
+  if (!object) {
+    throw std::runtime_error("instance does not match the field table");
+  }
+  auto target = static_cast<char *>(buffer);
+  for (auto &&name : fields) {
+    auto &field = getField(table, name);
+    std::memcpy(target, object + field.offset, field.size);
+    target += field.size;
+  }
+}
+
+void glue::writeFields(const Instance &instance, const std::vector<Key> &fields,
+                       const void *buffer) {
+  auto &table = getInstanceFieldTable(instance);
+  auto object = static_cast<char *>(table.getObject(*instance));
+  if (!object) {
+    throw std::runtime_error("cannot write fields of a const instance");
+  }
+  // validate all fields before writing any
+  for (auto &&name : fields) {
+    if (getField(table, name).readOnly) {
+      throw std::runtime_error("field " + name.str() + " is read-only");
+    }
+  }
+  auto source = static_cast<const char *>(buffer);
+  for (auto &&name : fields) {
+    auto &field = *table.find(name);
+    std::memcpy(object + field.offset, source, field.size);
+    source += field.size;
+  }
+}
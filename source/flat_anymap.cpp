@@ -0,0 +1,79 @@
+#include <glue/flat_anymap.h>
+
+using namespace glue;
+
+namespace {
+  size_t indexCapacityFor(size_t size) {
+    // keep the load factor at or below 1/2
+    size_t capacity = 16;
+    while (capacity < size * 2) capacity *= 2;
+    return capacity;
+  }
+}  // namespace
+
+size_t FlatAnyMap::find(const Key &key) const {
+  if (index.empty()) {
+    for (size_t i = 0; i < entries.size(); ++i) {
+      if (entries[i].first == key) return i;
+    }
+    return entries.size();
+  }
+  auto mask = index.size() - 1;
+  for (auto slot = key.hash() & mask;; slot = (slot + 1) & mask) {
+    auto i = index[slot];
+    if (i == 0) return entries.size();
+    if (entries[i - 1].first == key) return i - 1;
+  }
+}
+
+void FlatAnyMap::insertIndex(uint32_t entry) {
+  auto mask = index.size() - 1;
+  auto slot = entries[entry].first.hash() & mask;
+  while (index[slot] != 0) slot = (slot + 1) & mask;
+  index[slot] = entry + 1;
+}
+
+void FlatAnyMap::rebuildIndex(size_t capacity) {
+  index.assign(capacity, 0);
+  for (uint32_t i = 0; i < entries.size(); ++i) {
+    insertIndex(i);
+  }
+}
+
+void FlatAnyMap::reserve(size_t size) {
+  entries.reserve(size);
+  if (size > smallSize && index.size() < indexCapacityFor(size)) {
+    rebuildIndex(indexCapacityFor(size));
+  }
+}
+
+Any FlatAnyMap::get(const Key &key) const {
+  auto i = find(key);
+  if (i < entries.size()) {
+    return entries[i].second;
+  } else {
+    return Any();
+  }
+}
+
+void FlatAnyMap::set(const Key &key, const Any &value) {
+  ++currentVersion;
+  auto i = find(key);
+  if (i < entries.size()) {
+    entries[i].second = value;
+    return;
+  }
+  entries.emplace_back(key, value);
+  if (index.size() >= entries.size() * 2) {
+    insertIndex(uint32_t(entries.size() - 1));
+  } else if (entries.size() > smallSize) {
+    rebuildIndex(indexCapacityFor(entries.size()));
+  }
+}
+
+bool FlatAnyMap::forEach(const std::function<bool(const std::string &)> &callback) const {
+  for (auto &&entry : entries) {
+    if (callback(entry.first.str())) return true;
+  }
+  return false;
+}
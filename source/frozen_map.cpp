@@ -0,0 +1,140 @@
+#include <glue/frozen_map.h>
+#include <glue/keys.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_set>
+
+using namespace glue;
+
+namespace {
+
+  /**
+   * splitmix64 finalizer
+   */
+  uint64_t mix(const Key &key, uint64_t seed) {
+    auto x = uint64_t(reinterpret_cast<uintptr_t>(key.id())) + seed * 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+  }
+
+}  // namespace
+
+FrozenMap::FrozenMap(std::vector<Entry> source) : count(source.size()) {
+  std::unordered_set<Key> keys;
+  for (auto &&entry : source) {
+    if (!keys.insert(entry.key).second) {
+      throw std::runtime_error("duplicate key " + entry.key.str() + " in frozen map");
+    }
+  }
+  if (source.empty()) return;
+
+  // retry with more free slots if a bucket can't be placed in a bounded number of attempts
+  std::vector<size_t> target;
+  auto size = source.size();
+  for (size_t attempt = 0; attempt < maxAttempts; ++attempt, size += size / 4 + 1) {
+    target = place(source, size);
+    if (!target.empty()) break;
+  }
+  if (target.empty()) {
+    throw std::runtime_error("could not create frozen map");
+  }
+
+  entries.resize(size, Entry{Key(), Any(), true});
+  for (size_t i = 0; i < source.size(); ++i) {
+    entries[target[i]] = std::move(source[i]);
+  }
+}
+
+std::vector<size_t> FrozenMap::place(const std::vector<Entry> &source, size_t size) {
+  // hash and displace: distribute the keys into buckets, then find a displacement for each
+  // bucket that moves all of its keys into free slots, starting with the largest buckets
+  displacements.assign(size, 0);
+  std::vector<std::vector<uint32_t>> buckets(size);
+  for (uint32_t i = 0; i < source.size(); ++i) {
+    buckets[mix(source[i].key, 0) % size].push_back(i);
+  }
+  std::vector<uint32_t> order(size);
+  for (uint32_t i = 0; i < size; ++i) order[i] = i;
+  std::stable_sort(order.begin(), order.end(),
+                   [&](auto a, auto b) { return buckets[a].size() > buckets[b].size(); });
+
+  auto maxDisplacement = uint32_t(std::min<size_t>(64 * size + 1024, UINT32_MAX));
+  std::vector<bool> occupied(size, false);
+  std::vector<size_t> slots;
+  std::vector<size_t> target(source.size());
+  for (auto b : order) {
+    auto &bucket = buckets[b];
+    if (bucket.empty()) break;
+    for (uint32_t d = 1;; ++d) {
+      if (d > maxDisplacement) return {};
+      slots.clear();
+      for (auto i : bucket) {
+        auto s = mix(source[i].key, d) % size;
+        if (occupied[s] || std::find(slots.begin(), slots.end(), s) != slots.end()) break;
+        slots.push_back(s);
+      }
+      if (slots.size() == bucket.size()) {
+        displacements[b] = d;
+        for (size_t j = 0; j < bucket.size(); ++j) {
+          occupied[slots[j]] = true;
+          target[bucket[j]] = slots[j];
+        }
+        break;
+      }
+    }
+  }
+  return target;
+}
+
+size_t FrozenMap::slot(const Key &key) const {
+  auto size = entries.size();
+  return mix(key, displacements[mix(key, 0) % size]) % size;
+}
+
+Any FrozenMap::get(const Key &key) const {
+  if (entries.empty()) return Any();
+  auto &entry = entries[slot(key)];
+  if (entry.key == key) {
+    return entry.value;
+  } else {
+    return Any();
+  }
+}
+
+void FrozenMap::set(const Key &, const Any &) {
+  throw std::runtime_error("cannot modify a frozen map");
+}
+
+bool FrozenMap::forEach(const std::function<bool(const std::string &)> &callback) const {
+  for (auto &&entry : entries) {
+    if (!entry.inherited && callback(entry.key.str())) return true;
+  }
+  return false;
+}
+
+MapValue glue::createFrozenMap(const MapValue &map) {
+  std::vector<FrozenMap::Entry> entries;
+  std::unordered_set<Key> keys;
+
+  map.forEach([&](auto &&key, auto &&value) {
+    keys.insert(key);
+    entries.push_back(FrozenMap::Entry{key, *value, false});
+    return false;
+  });
+
+  // copy inherited entries, resolved from the original map to respect overrides
+  auto base = Value(map.rawGet(keys::extendsKey)).asMap();
+  while (base) {
+    base.forEach([&](auto &&key, auto &&) {
+      if (keys.insert(key).second) {
+        entries.push_back(FrozenMap::Entry{key, *map.get(key), true});
+      }
+      return false;
+    });
+    base = base.rawGet(keys::extendsKey).asMap();
+  }
+
+  return MapValue{std::make_shared<FrozenMap>(std::move(entries))};
+}
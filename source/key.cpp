@@ -0,0 +1,78 @@
+#include <glue/key.h>
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+using namespace glue;
+
+namespace {
+  struct KeyTable {
+    std::mutex mutex;
+    std::unordered_map<std::string_view, std::unique_ptr<detail::KeyData>> keys;
+  };
+
+  KeyTable &getKeyTable() {
+    // intentionally leaked so keys remain valid during static destruction
+    static auto table = new KeyTable();
+    return *table;
+  }
+
+  /**
+   * A direct-mapped cache of interned keys per thread. Interned keys are never released, so
+   * threads can cache them without synchronization. A key replaces the previous entry of its
+   * slot, which bounds the cache for dynamic keys without ever clearing it. The cache is
+   * trivially destructible, so keys can still be created during thread or static destruction.
+   */
+  constexpr size_t localCacheSize = 4096;
+  thread_local std::array<const detail::KeyData *, localCacheSize> localKeyCache{};
+
+  const detail::KeyData *&localSlot(size_t hash) {
+    return localKeyCache[hash & (localCacheSize - 1)];
+  }
+
+  bool matches(const detail::KeyData *data, std::string_view name, size_t hash) {
+    return data && data->hash == hash && data->name == name;
+  }
+
+  const detail::KeyData *findShared(std::string_view name) {
+    auto &table = getKeyTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    auto it = table.keys.find(name);
+    return it != table.keys.end() ? it->second.get() : nullptr;
+  }
+
+  const detail::KeyData *internShared(std::string_view name, size_t hash) {
+    auto &table = getKeyTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    if (auto it = table.keys.find(name); it != table.keys.end()) {
+      return it->second.get();
+    }
+    auto data = std::make_unique<detail::KeyData>(detail::KeyData{std::string(name), hash});
+    auto result = data.get();
+    // the table key must view the interned string, not the argument
+    table.keys.emplace(result->name, std::move(data));
+    return result;
+  }
+}  // namespace
+
+const detail::KeyData *detail::internKey(std::string_view name) {
+  auto hash = std::hash<std::string_view>()(name);
+  auto &slot = localSlot(hash);
+  if (!matches(slot, name, hash)) {
+    slot = internShared(name, hash);
+  }
+  return slot;
+}
+
+const detail::KeyData *detail::findKey(std::string_view name) {
+  auto hash = std::hash<std::string_view>()(name);
+  auto &slot = localSlot(hash);
+  if (!matches(slot, name, hash)) {
+    auto result = findShared(name);
+    if (!result) return nullptr;
+    slot = result;
+  }
+  return slot;
+}
@@ -0,0 +1,66 @@
+#include <glue/lazy_map.h>
+
+using namespace glue;
+
+Any LazyMap::get(const Key &key) const {
+  auto it = entries.find(key);
+  if (it == entries.end()) {
+    return Any();
+  }
+  auto &entry = it->second;
+  if (entry.materialized.load(std::memory_order_acquire)) {
+    return entry.value;
+  }
+  std::lock_guard<std::recursive_mutex> guard(factoryMutex);
+  if (entry.factory) {
+    // take the factory before calling it so recursive lookups of the key don't recurse again
+    // and restore it if it throws, so the lookup can be retried
+    auto factory = std::move(entry.factory);
+    entry.factory = nullptr;
+    try {
+      entry.value = factory();
+    } catch (...) {
+      entry.factory = std::move(factory);
+      throw;
+    }
+    entry.materialized.store(true, std::memory_order_release);
+  }
+  return entry.value;
+}
+
+void LazyMap::set(const Key &key, const Any &value) {
+  auto &entry = entries[key];
+  entry.value = value;
+  entry.factory = nullptr;
+  entry.materialized.store(true, std::memory_order_relaxed);
+  ++currentVersion;
+}
+
+void LazyMap::setFactoryFunction(const Key &key, Factory factory, const ClassInfo *classHint) {
+  auto &entry = entries[key];
+  entry.value = Any();
+  entry.factory = std::move(factory);
+  entry.classHint = classHint;
+  entry.materialized.store(false, std::memory_order_relaxed);
+  ++currentVersion;
+}
+
+bool LazyMap::isMaterialized(const Key &key) const {
+  auto it = entries.find(key);
+  return it != entries.end() && it->second.materialized.load(std::memory_order_acquire);
+}
+
+const ClassInfo *LazyMap::getClassHint(const Key &key) const {
+  auto it = entries.find(key);
+  if (it == entries.end() || it->second.materialized.load(std::memory_order_acquire)) {
+    return nullptr;
+  }
+  return it->second.classHint;
+}
+
+bool LazyMap::forEach(const std::function<bool(const std::string &)> &callback) const {
+  for (auto &&entry : entries) {
+    if (callback(entry.first.str())) return true;
+  }
+  return false;
+}
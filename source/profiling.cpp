@@ -0,0 +1,311 @@
+#include <glue/detail/typed_method.h>
+#include <glue/keys.h>
+#include <glue/profiling.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+using namespace glue;
+
+namespace glue {
+  namespace detail {
+
+    /**
+     * The counters of a key, updated without locking
+     */
+    struct KeySlot {
+      std::atomic<uint64_t> gets{0}, sets{0}, misses{0}, extendsHops{0}, calls{0},
+          callNanoseconds{0};
+      std::array<std::atomic<uint64_t>, KeyProfile().latencyHistogram.size()> latencyHistogram{};
+
+      KeyProfile snapshot() const {
+        KeyProfile result;
+        result.gets = gets.load(std::memory_order_relaxed);
+        result.sets = sets.load(std::memory_order_relaxed);
+        result.misses = misses.load(std::memory_order_relaxed);
+        result.extendsHops = extendsHops.load(std::memory_order_relaxed);
+        result.calls = calls.load(std::memory_order_relaxed);
+        result.callNanoseconds = callNanoseconds.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < latencyHistogram.size(); ++i) {
+          result.latencyHistogram[i] = latencyHistogram[i].load(std::memory_order_relaxed);
+        }
+        return result;
+      }
+
+      void reset() {
+        for (auto counter : {&gets, &sets, &misses, &extendsHops, &calls, &callNanoseconds}) {
+          counter->store(0, std::memory_order_relaxed);
+        }
+        for (auto &count : latencyHistogram) count.store(0, std::memory_order_relaxed);
+      }
+    };
+
+    struct MapProfile {
+      /**
+       * Keeps the map alive, so its address identifies it for the lifetime of the profile
+       */
+      std::shared_ptr<Map> map;
+      std::string name;
+      /**
+       * Only held exclusively to add keys, slots are never removed
+       */
+      std::shared_mutex mutex;
+      std::unordered_map<Key, std::shared_ptr<KeySlot>> keys;
+
+      const std::shared_ptr<KeySlot> &slot(const Key &key) {
+        {
+          std::shared_lock<std::shared_mutex> lock(mutex);
+          auto it = keys.find(key);
+          if (it != keys.end()) return it->second;
+        }
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        auto &slot = keys[key];
+        if (!slot) slot = std::make_shared<KeySlot>();
+        return slot;
+      }
+    };
+
+    struct ProfileData {
+      std::mutex mutex;
+      std::unordered_map<const Map *, std::shared_ptr<MapProfile>> maps;
+
+      std::shared_ptr<MapProfile> getMapProfile(const std::shared_ptr<Map> &map,
+                                                const std::string &name) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto &profile = maps[map.get()];
+        if (!profile) {
+          profile = std::make_shared<MapProfile>();
+          profile->map = map;
+          profile->name = name;
+        }
+        return profile;
+      }
+    };
+
+  }  // namespace detail
+}  // namespace glue
+
+namespace {
+
+  using Clock = std::chrono::steady_clock;
+
+  size_t latencyBucket(uint64_t nanoseconds) {
+    size_t bucket = 0;
+    while (nanoseconds > 0 && bucket + 1 < KeyProfile().latencyHistogram.size()) {
+      nanoseconds >>= 1;
+      ++bucket;
+    }
+    return bucket;
+  }
+
+  std::string childName(const std::string &parent, const std::string &key) {
+    return parent.empty() ? key : parent + "." + key;
+  }
+
+  void printJSONString(std::ostream &stream, const std::string &string) {
+    stream << '"';
+    for (auto c : string) {
+      if (c == '"' || c == '\\') {
+        stream << '\\' << c;
+      } else if (static_cast<unsigned char>(c) < 0x20) {
+        stream << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c) << std::dec
+               << std::setfill(' ');
+      } else {
+        stream << c;
+      }
+    }
+    stream << '"';
+  }
+
+}  // namespace
+
+Profile::Profile() : data(std::make_shared<detail::ProfileData>()) {}
+
+MapValue Profile::wrap(const MapValue &map, const std::string &name) const {
+  if (auto profiling = std::dynamic_pointer_cast<ProfilingMap>(map.data)) {
+    if (profiling->profile.data == data) return map;
+  }
+  return MapValue{std::make_shared<ProfilingMap>(map.data, *this, name)};
+}
+
+MapValue glue::unwrapProfiling(const MapValue &map) {
+  if (auto profiling = std::dynamic_pointer_cast<ProfilingMap>(map.data)) {
+    return unwrapProfiling(MapValue(profiling->getInner()));
+  }
+  return map;
+}
+
+std::vector<Profile::Entry> Profile::entries() const {
+  std::vector<Entry> result;
+  {
+    std::lock_guard<std::mutex> lock(data->mutex);
+    for (auto &&map : data->maps) {
+      std::shared_lock<std::shared_mutex> mapLock(map.second->mutex);
+      for (auto &&key : map.second->keys) {
+        auto counters = key.second->snapshot();
+        // keys that were only used to cache wrappers or that were reset have no counts
+        if (counters.gets == 0 && counters.sets == 0 && counters.calls == 0) continue;
+        result.push_back(Entry{map.second->name, key.first.str(), counters});
+      }
+    }
+  }
+  std::sort(result.begin(), result.end(), [](const Entry &a, const Entry &b) {
+    auto &x = a.counters, &y = b.counters;
+    if (x.callNanoseconds != y.callNanoseconds) return x.callNanoseconds > y.callNanoseconds;
+    if (x.gets + x.sets != y.gets + y.sets) return x.gets + x.sets > y.gets + y.sets;
+    return std::tie(a.path, a.key) < std::tie(b.path, b.key);
+  });
+  return result;
+}
+
+void Profile::printReport(std::ostream &stream) const {
+  stream << std::left << std::setw(40) << "key" << std::right << std::setw(10) << "gets"
+         << std::setw(10) << "sets" << std::setw(10) << "misses" << std::setw(10) << "hops"
+         << std::setw(10) << "calls" << std::setw(14) << "total ns" << std::setw(12) << "mean ns"
+         << '\n';
+  for (auto &&entry : entries()) {
+    auto &c = entry.counters;
+    stream << std::left << std::setw(40) << childName(entry.path, entry.key) << std::right
+           << std::setw(10) << c.gets << std::setw(10) << c.sets << std::setw(10) << c.misses
+           << std::setw(10) << c.extendsHops << std::setw(10) << c.calls << std::setw(14)
+           << c.callNanoseconds << std::setw(12) << (c.calls ? c.callNanoseconds / c.calls : 0)
+           << '\n';
+  }
+}
+
+void Profile::printJSON(std::ostream &stream) const {
+  stream << '[';
+  bool first = true;
+  for (auto &&entry : entries()) {
+    auto &c = entry.counters;
+    stream << (first ? "\n" : ",\n") << "  {\"path\": ";
+    first = false;
+    printJSONString(stream, entry.path);
+    stream << ", \"key\": ";
+    printJSONString(stream, entry.key);
+    stream << ", \"gets\": " << c.gets << ", \"sets\": " << c.sets << ", \"misses\": " << c.misses
+           << ", \"extendsHops\": " << c.extendsHops << ", \"calls\": " << c.calls
+           << ", \"callNanoseconds\": " << c.callNanoseconds << ", \"latencyHistogram\": [";
+    // trailing empty buckets are omitted
+    auto end = c.latencyHistogram.size();
+    while (end > 0 && c.latencyHistogram[end - 1] == 0) --end;
+    for (size_t i = 0; i < end; ++i) {
+      stream << (i ? ", " : "") << c.latencyHistogram[i];
+    }
+    stream << "]}";
+  }
+  stream << (first ? "]" : "\n]") << '\n';
+}
+
+void Profile::reset() const {
+  std::lock_guard<std::mutex> lock(data->mutex);
+  for (auto &&map : data->maps) {
+    std::shared_lock<std::shared_mutex> mapLock(map.second->mutex);
+    for (auto &&key : map.second->keys) key.second->reset();
+  }
+}
+
+ProfilingMap::ProfilingMap(std::shared_ptr<Map> i, Profile p, const std::string &name)
+    : inner(std::move(i)), profile(std::move(p)) {
+  mapProfile = profile.data->getMapProfile(inner, name);
+}
+
+namespace {
+
+  /**
+   * Returns the number of extends maps visited to resolve a key missing in `map`
+   */
+  uint64_t extendsDepth(const Map &map, const Key &key) {
+    uint64_t depth = 0;
+    for (auto base = Value(map.get(keys::extendsKey)).asMap(); base;
+         base = base.rawGet(keys::extendsKey).asMap()) {
+      ++depth;
+      if (base.rawGet(key)) break;
+    }
+    return depth;
+  }
+
+}  // namespace
+
+Any ProfilingMap::get(const Key &key) const {
+  if (key == keys::typedMethodsKey) {
+    return Any();
+  }
+  auto value = inner->get(key);
+  if (key == keys::classKey || key == keys::fieldsKey) {
+    return value;
+  }
+
+  // maps and functions are wrapped, the wrapper is reused until the value changes
+  auto map = Value(value).asMap();
+  auto source = map ? static_cast<const void *>(map.data.get()) : detail::functionIdentity(value);
+  detail::KeySlot *slot = nullptr;
+  Any wrapper;
+  {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    auto it = entries.find(key);
+    if (it != entries.end()) {
+      slot = it->second.slot.get();
+      if (source && it->second.source == source) wrapper = it->second.wrapper;
+    }
+  }
+  if (!slot || (source && !wrapper)) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    auto &entry = entries[key];
+    if (!entry.slot) entry.slot = mapProfile->slot(key);
+    slot = entry.slot.get();
+    if (source && entry.source != source) {
+      entry.wrapper = map ? Any(profile.wrap(map, childName(mapProfile->name, key.str())).data)
+                          : wrapFunction(Value(value).asFunction(), entry.slot);
+      // keep the value alive, so that its address can't be reused by a different value
+      entry.value = value;
+      entry.source = source;
+    }
+    if (source) wrapper = entry.wrapper;
+  }
+
+  if (key != keys::extendsKey) {
+    slot->gets.fetch_add(1, std::memory_order_relaxed);
+    if (!value) {
+      slot->misses.fetch_add(1, std::memory_order_relaxed);
+      slot->extendsHops.fetch_add(extendsDepth(*inner, key), std::memory_order_relaxed);
+    }
+  }
+  return source ? wrapper : value;
+}
+
+Any ProfilingMap::wrapFunction(const AnyFunction &function,
+                               const std::shared_ptr<detail::KeySlot> &slot) {
+  return detail::convertArgumentToAny([function, slot](const AnyArguments &arguments) {
+    auto record = [&](Clock::time_point start) {
+      auto nanoseconds = uint64_t(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+      slot->calls.fetch_add(1, std::memory_order_relaxed);
+      slot->callNanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+      slot->latencyHistogram[latencyBucket(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    };
+    auto start = Clock::now();
+    try {
+      auto returned = function.call(arguments);
+      record(start);
+      return returned;
+    } catch (...) {
+      record(start);
+      throw;
+    }
+  });
+}
+
+void ProfilingMap::set(const Key &key, const Any &value) {
+  mapProfile->slot(key)->sets.fetch_add(1, std::memory_order_relaxed);
+  inner->set(key, value);
+}
+
+bool ProfilingMap::forEach(const std::function<bool(const std::string &)> &callback) const {
+  return inner->forEach(callback);
+}
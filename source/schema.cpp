@@ -0,0 +1,258 @@
+#include <glue/class.h>
+#include <glue/profiling.h>
+#include <glue/schema.h>
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+
+using namespace glue;
+using namespace glue::schema;
+
+namespace {
+
+  bool isInternalKey(const Key &key) {
+    return key == keys::classKey || key == keys::extendsKey || key == keys::typedMethodsKey
+           || key == keys::fieldsKey;
+  }
+
+  class SchemaWriter {
+  public:
+    explicit SchemaWriter(const Context *c) : context(c) {}
+
+    void write(std::ostream &stream, const MapValue &root) {
+      nodes.emplace_back(createNode(NodeKind::Module, ""));
+      queue.push_back(Pending{0, root, std::nullopt});
+      while (!queue.empty()) {
+        auto pending = std::move(queue.front());
+        queue.pop_front();
+        addChildren(pending);
+      }
+
+      Header header;
+      std::memcpy(header.magic, magic, sizeof(magic));
+      header.version = version;
+      header.byteOrderMark = byteOrderMark;
+      header.stringOffset = sizeof(Header);
+      header.stringSize = uint32_t(strings.size());
+      // keep the records aligned
+      strings.resize((strings.size() + 3) / 4 * 4);
+      header.typeOffset = header.stringOffset + uint32_t(strings.size());
+      header.typeCount = uint32_t(types.size());
+      header.nodeOffset = header.typeOffset + uint32_t(types.size() * sizeof(TypeRecord));
+      header.nodeCount = uint32_t(nodes.size());
+      header.parameterOffset = header.nodeOffset + uint32_t(nodes.size() * sizeof(NodeRecord));
+      header.parameterCount = uint32_t(parameters.size());
+
+      stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+      stream.write(strings.data(), std::streamsize(strings.size()));
+      stream.write(reinterpret_cast<const char *>(types.data()),
+                   std::streamsize(types.size() * sizeof(TypeRecord)));
+      stream.write(reinterpret_cast<const char *>(nodes.data()),
+                   std::streamsize(nodes.size() * sizeof(NodeRecord)));
+      stream.write(reinterpret_cast<const char *>(parameters.data()),
+                   std::streamsize(parameters.size() * sizeof(uint32_t)));
+    }
+
+  private:
+    struct Pending {
+      uint32_t node;
+      MapValue map;
+      std::optional<ClassInfo> currentClass;
+    };
+
+    const Context *context;
+    std::string strings;
+    std::unordered_map<std::string, StringRef> stringRefs;
+    std::vector<TypeRecord> types;
+    std::unordered_map<TypeIndex, uint32_t> typeRefs;
+    std::vector<NodeRecord> nodes;
+    std::vector<uint32_t> parameters;
+    std::deque<Pending> queue;
+
+    StringRef addString(const std::string &string) {
+      auto it = stringRefs.find(string);
+      if (it != stringRefs.end()) return it->second;
+      StringRef ref{uint32_t(strings.size()), uint32_t(string.size())};
+      strings += string;
+      return stringRefs.emplace(string, ref).first->second;
+    }
+
+    uint32_t addType(const TypeID &type) {
+      auto it = typeRefs.find(type.index);
+      if (it != typeRefs.end()) return it->second;
+      std::string path;
+      if (auto info = context ? context->getTypeInfo(type.index) : nullptr) {
+        for (auto &&p : info->path) {
+          if (!path.empty()) path += '.';
+          path += p;
+        }
+      }
+      types.push_back(TypeRecord{addString(std::string(type.name)), addString(path)});
+      return typeRefs.emplace(type.index, uint32_t(types.size() - 1)).first->second;
+    }
+
+    NodeRecord createNode(NodeKind kind, const std::string &name) {
+      NodeRecord node;
+      node.kind = kind;
+      node.flags = 0;
+      node.name = addString(name);
+      node.type = none;
+      node.extends = none;
+      node.firstChild = node.childCount = 0;
+      node.firstParameter = node.parameterCount = 0;
+      return node;
+    }
+
+    static bool isReceiver(const TypeID &type, const ClassInfo &info) {
+      return type == info.typeID || type == info.constTypeID || type == info.sharedTypeID
+             || type == info.sharedConstTypeID || type == getTypeID<Any>();
+    }
+
+    /**
+     * Creates the record of a function, classified in the same way as by `DeclarationPrinter`
+     */
+    NodeRecord createFunctionNode(const std::string &name, const AnyFunction &f,
+                                  const std::optional<ClassInfo> &currentClass) {
+      auto kind = NodeKind::Function;
+      size_t firstArgument = 0;
+      if (currentClass) {
+        if (name == keys::constructorName) {
+          kind = NodeKind::Constructor;
+        } else if (!f.isVariadic() && f.argumentCount() > 0
+                   && isReceiver(f.argumentType(0), *currentClass)) {
+          kind = NodeKind::Method;
+          firstArgument = 1;
+        } else {
+          kind = NodeKind::StaticMethod;
+        }
+      }
+      auto node = createNode(kind, name);
+      node.type = addType(f.returnType());
+      if (f.isVariadic()) {
+        node.flags |= Variadic;
+      } else {
+        node.firstParameter = uint32_t(parameters.size());
+        node.parameterCount = uint32_t(f.argumentCount() - firstArgument);
+        for (size_t i = firstArgument; i < f.argumentCount(); ++i) {
+          parameters.push_back(addType(f.argumentType(i)));
+        }
+      }
+      return node;
+    }
+
+    void addChildren(const Pending &pending) {
+      auto keys = pending.map.keys();
+      keys.erase(std::remove_if(keys.begin(), keys.end(), isInternalKey), keys.end());
+      std::sort(keys.begin(), keys.end());
+      auto first = uint32_t(nodes.size());
+      nodes[pending.node].firstChild = first;
+      nodes[pending.node].childCount = uint32_t(keys.size());
+      nodes.resize(nodes.size() + keys.size());
+
+      for (size_t i = 0; i < keys.size(); ++i) {
+        auto &name = keys[i];
+        auto value = pending.map.rawGet(name);
+        auto index = first + uint32_t(i);
+        NodeRecord node;
+        if (auto map = value.asMap()) {
+          if (auto classInfo = map.getUncached(keys::classKey)) {
+            auto info = classInfo->get<ClassInfo>();
+            node = createNode(NodeKind::Class, name);
+            node.type = addType(info.typeID);
+            if (auto base = map.getUncached(keys::extendsKey).asMap()) {
+              if (auto baseClass = base.getUncached(keys::classKey)) {
+                node.extends = addType(baseClass->get<ClassInfo>().typeID);
+              }
+            }
+            queue.push_back(Pending{index, map, info});
+          } else {
+            node = createNode(NodeKind::Module, name);
+            queue.push_back(Pending{index, map, pending.currentClass});
+          }
+        } else if (auto f = value.asFunction()) {
+          node = createFunctionNode(name, f, pending.currentClass);
+        } else {
+          node = createNode(NodeKind::Value, name);
+          node.type = addType(value->type());
+        }
+        nodes[index] = node;
+      }
+    }
+  };
+
+}  // namespace
+
+void glue::writeSchema(std::ostream &stream, const MapValue &root, const Context *context) {
+  // profiled maps hide function signatures
+  SchemaWriter(context).write(stream, unwrapProfiling(root));
+}
+
+SchemaView::SchemaView(const void *d, size_t s) : data(static_cast<const char *>(d)), size(s) {
+  headerRecord = reinterpret_cast<const Header *>(data);
+  auto fits = [&](uint64_t offset, uint64_t count, uint64_t elementSize) {
+    return offset + count * elementSize <= size;
+  };
+  if (size < sizeof(Header) || std::memcmp(headerRecord->magic, magic, sizeof(magic)) != 0) {
+    throw std::runtime_error("invalid schema");
+  }
+  if (headerRecord->version != version || headerRecord->byteOrderMark != byteOrderMark) {
+    throw std::runtime_error("unsupported schema version or byte order");
+  }
+  auto &h = *headerRecord;
+  if (!fits(h.stringOffset, h.stringSize, 1)
+      || !fits(h.typeOffset, h.typeCount, sizeof(TypeRecord))
+      || !fits(h.nodeOffset, h.nodeCount, sizeof(NodeRecord))
+      || !fits(h.parameterOffset, h.parameterCount, sizeof(uint32_t)) || h.nodeCount == 0) {
+    throw std::runtime_error("truncated schema");
+  }
+}
+
+const NodeRecord &SchemaView::node(uint32_t index) const {
+  if (index >= headerRecord->nodeCount) throw std::runtime_error("invalid schema node");
+  return reinterpret_cast<const NodeRecord *>(data + headerRecord->nodeOffset)[index];
+}
+
+const TypeRecord &SchemaView::type(uint32_t index) const {
+  if (index >= headerRecord->typeCount) throw std::runtime_error("invalid schema type");
+  return reinterpret_cast<const TypeRecord *>(data + headerRecord->typeOffset)[index];
+}
+
+const NodeRecord &SchemaView::child(const NodeRecord &parent, uint32_t index) const {
+  if (index >= parent.childCount) throw std::runtime_error("invalid schema child");
+  return node(parent.firstChild + index);
+}
+
+uint32_t SchemaView::parameter(const NodeRecord &parent, uint32_t index) const {
+  auto position = uint64_t(parent.firstParameter) + index;
+  if (index >= parent.parameterCount || position >= headerRecord->parameterCount) {
+    throw std::runtime_error("invalid schema parameter");
+  }
+  return reinterpret_cast<const uint32_t *>(data + headerRecord->parameterOffset)[position];
+}
+
+std::string_view SchemaView::string(StringRef ref) const {
+  if (uint64_t(ref.offset) + ref.size > headerRecord->stringSize) {
+    throw std::runtime_error("invalid schema string");
+  }
+  return std::string_view(data + headerRecord->stringOffset + ref.offset, ref.size);
+}
+
+const NodeRecord *SchemaView::find(const NodeRecord &parent, std::string_view name) const {
+  uint32_t begin = 0, end = parent.childCount;
+  while (begin < end) {
+    auto middle = begin + (end - begin) / 2;
+    auto &candidate = child(parent, middle);
+    auto compare = string(candidate.name).compare(name);
+    if (compare == 0) return &candidate;
+    if (compare < 0) {
+      begin = middle + 1;
+    } else {
+      end = middle;
+    }
+  }
+  return nullptr;
+}
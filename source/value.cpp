@@ -1,4 +1,6 @@
 #include <glue/anymap.h>
+#include <glue/concurrent_anymap.h>
+#include <glue/flat_anymap.h>
 #include <glue/keys.h>
 #include <glue/value.h>
 
@@ -6,6 +8,20 @@ using namespace glue;
 
 MapValue glue::createAnyMap() { return MapValue{std::make_shared<AnyMap>()}; }
 
+MapValue glue::createAnyMap(std::pmr::memory_resource *resource) {
+  return MapValue{
+      std::allocate_shared<AnyMap>(std::pmr::polymorphic_allocator<AnyMap>(resource), resource)};
+}
+
+MapValue glue::createFlatMap() { return MapValue{std::make_shared<FlatAnyMap>()}; }
+
+MapValue glue::createFlatMap(std::pmr::memory_resource *resource) {
+  return MapValue{std::allocate_shared<FlatAnyMap>(
+      std::pmr::polymorphic_allocator<FlatAnyMap>(resource), resource)};
+}
+
+MapValue glue::createConcurrentMap() { return MapValue{std::make_shared<ConcurrentAnyMap>()}; }
+
 MapValue Value::asMap() const { return MapValue{data.getShared<Map>()}; }
 
 AnyFunction Value::asFunction() const {
@@ -16,7 +32,7 @@ AnyFunction Value::asFunction() const {
   }
 }
 
-MappedValue Value::operator[](const std::string &key) const {
+MappedValue Value::operator[](const Key &key) const {
   if (auto map = asMap()) {
     return MapValue(map)[key];
   } else {
@@ -37,24 +53,173 @@ std::vector<std::string> MapValue::keys() const {
   return keys;
 }
 
-Value MapValue::get(const std::string &key) const {
-  if (auto result = data->get(key)) {
-    return result;
-  } else if (Value extends = data->get(keys::extendsKey)) {
-    if (MapValue map = extends.asMap()) {
-      return map.get(key);
+namespace {
+
+  Value getFromBase(const MapValue &map, const Key &key) {
+    Value extends = map.data->get(keys::extendsKey);
+    if (MapValue base = extends.asMap()) {
+      return base.get(key);
+    } else if (auto callback = extends.asFunction()) {
+      return callback(map, key.str());
+    }
+    return Value();
+  }
+
+  using Chain = std::array<const Map *, detail::ResolutionCache::maxDepth>;
+
+  /**
+   * Copies the chain into `chain` and returns its depth, or `0` if it is outdated
+   */
+  uint32_t loadChain(const detail::ResolutionCache &cache, Chain &chain) {
+    auto depth = cache.depth.load(std::memory_order_relaxed);
+    for (uint32_t i = 0; i < depth; ++i) {
+      auto &link = cache.chain[i];
+      chain[i] = link.map.load(std::memory_order_relaxed);
+      // the maps are kept alive by the extends entries of their unchanged predecessors
+      if (chain[i]->version() != link.version.load(std::memory_order_relaxed)) return 0;
+    }
+    return depth;
+  }
+
+  /**
+   * Rebuilds the chain if no other thread is, returns the new sequence or an odd value
+   */
+  uint64_t rebuild(const Map &map, detail::ResolutionCache &cache, uint64_t sequence) {
+    if (!cache.sequence.compare_exchange_strong(sequence, sequence + 1,
+                                                std::memory_order_acquire)) {
+      return 1;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    uint32_t depth = 0;
+    bool cacheable = false;
+    for (auto current = &map; depth < cache.chain.size();) {
+      auto version = current->version();
+      cache.chain[depth].map.store(current, std::memory_order_relaxed);
+      cache.chain[depth].version.store(version, std::memory_order_relaxed);
+      ++depth;
+      if (version == 0) break;
+      Value extends = current->get(keys::extendsKey);
+      if (!extends) {
+        cacheable = true;
+        break;
+      }
+      if (auto base = extends.asMap()) {
+        current = base.data.get();
+      } else {
+        break;
+      }
+    }
+    cache.depth.store(depth, std::memory_order_relaxed);
+    cache.cacheable.store(cacheable, std::memory_order_relaxed);
+    for (auto &slot : cache.slots) {
+      slot.key.store(nullptr, std::memory_order_relaxed);
+      slot.entry.store(0, std::memory_order_relaxed);
+    }
+    cache.sequence.store(sequence + 2, std::memory_order_release);
+    return sequence + 2;
+  }
+
+  /**
+   * Resolves a key that is not in the map itself through the cache, or returns `false` if the
+   * cache can't be used
+   */
+  bool cachedGet(const MapValue &map, detail::ResolutionCache &cache, const Key &key,
+                 Value &result) {
+    auto sequence = cache.sequence.load(std::memory_order_acquire);
+    if (sequence & 1) return false;
+    Chain chain;
+    auto depth = loadChain(cache, chain);
+    if (depth == 0) {
+      sequence = rebuild(*map.data, cache, sequence);
+      if (sequence & 1) return false;
+      depth = loadChain(cache, chain);
+      if (depth == 0) return false;
+    }
+    if (!cache.cacheable.load(std::memory_order_relaxed)) return false;
+
+    auto resolve = [&]() {
+      // the owner has already been searched
+      uint32_t position = 1;
+      for (; position < depth; ++position) {
+        if ((result = chain[position]->get(key))) break;
+      }
+      return position;
+    };
+    auto isCurrent = [&]() {
+      std::atomic_thread_fence(std::memory_order_acquire);
+      return cache.sequence.load(std::memory_order_relaxed) == sequence;
+    };
+
+    auto hash = key.hash();
+    for (size_t probe = 0; probe < detail::ResolutionCache::maxProbes; ++probe) {
+      auto &slot = cache.slots[(hash + probe) % cache.slots.size()];
+      auto id = slot.key.load(std::memory_order_acquire);
+      if (!id) {
+        auto position = resolve();
+        if (!isCurrent()) return false;
+        if (slot.key.compare_exchange_strong(id, key.id(), std::memory_order_acq_rel)) {
+          slot.entry.store(detail::ResolutionCache::tag(sequence, position),
+                           std::memory_order_release);
+          return true;
+        }
+        if (id != key.id()) continue;
+        return true;
+      }
+      if (id != key.id()) continue;
+      auto entry = slot.entry.load(std::memory_order_acquire);
+      if ((entry >> 16) == sequence) {
+        auto position = uint32_t(entry & 0xffff);
+        if (!isCurrent()) return false;
+        if (position < depth) result = chain[position]->get(key);
+        return true;
+      }
+      // the slot was resolved for an earlier chain
+      auto position = resolve();
+      if (!isCurrent()) return false;
+      slot.entry.compare_exchange_strong(entry, detail::ResolutionCache::tag(sequence, position),
+                                         std::memory_order_acq_rel);
+      return true;
+    }
+    resolve();
+    return isCurrent();
+  }
+
+}  // namespace
+
+Value MapValue::get(const Key &key) const {
+  if (auto result = data->get(key)) return result;
+  auto cache = data->resolutionCache.load();
+  if (!cache) {
+    // maps without a base never create a cache
+    if (!data->get(keys::extendsKey)) return Value();
+    // maps without version tracking, such as immutable maps, are never cached
+    if (data->version() == 0) return getFromBase(*this, key);
+    cache = &data->resolutionCache.create();
+  }
+  Value result;
+  if (cachedGet(*this, *cache, key, result)) return result;
+  return getFromBase(*this, key);
+}
+
+Value MapValue::getUncached(const Key &key) const {
+  for (auto map = *this;;) {
+    if (auto result = map.data->get(key)) return result;
+    Value extends = map.data->get(keys::extendsKey);
+    if (auto base = extends.asMap()) {
+      map = base;
     } else if (auto callback = extends.asFunction()) {
-      return callback(*this, key);
+      return callback(map, key.str());
+    } else {
+      return Value();
     }
   }
-  return Value();
 }
 
 void MapValue::setExtends(Value v) const { (*this)[keys::extendsKey] = std::move(v); }
 
-void MappedValue::set(const std::string &k, Any v) { parent.set(k, std::move(v)); }
+void MappedValue::set(const Key &k, Any v) { parent.set(k, std::move(v)); }
 
-const MapValue &MapValue::setValue(const std::string &key, Value value) const {
+const MapValue &MapValue::setValue(const Key &key, Value value) const {
   (*this)[key] = value;
   return *this;
 }
@@ -0,0 +1,93 @@
+#include <doctest/doctest.h>
+#include <glue/class.h>
+#include <glue/fields.h>
+#include <glue/static_class.h>
+
+#include "allocations.h"
+
+using namespace glue;
+
+namespace {
+
+  struct A {
+    int member = 1;
+    int method(int x) const { return member + x; }
+  };
+
+  struct B : public A {};
+
+}  // namespace
+
+TEST_CASE("Allocation budgets") {
+  Key methodKey = "method";
+  Key memberKey = "member";
+
+  SUBCASE("counting") {
+    auto count = allocations::count([]() {
+      // volatile prevents the allocation from being elided
+      int *volatile value = new int();
+      delete value;
+    });
+    CHECK(count.allocations == 1);
+    CHECK(count.bytes == sizeof(int));
+  }
+
+  SUBCASE("interned keys") {
+    CHECK(allocations::count([&]() { Key key("method"); }).allocations == 0);
+  }
+
+  SUBCASE("cached lookup through the extends chain") {
+    auto base = createAnyMap();
+    base["x"] = 1;
+    auto map = createAnyMap();
+    map.setExtends(base);
+    CHECK(map.get("x"));
+    Key key = "x";
+    CHECK(allocations::count([&]() { CHECK(map.get(key)); }).allocations == 0);
+  }
+
+  SUBCASE("frozen class") {
+    auto gA = createClass<A>()
+                  .addConstructor<>()
+                  .addMethod("method", &A::method)
+                  .addMember("member", &A::member)
+                  .freeze();
+    auto gB = createClass<B>(WithBases<A>()).setExtends(gA).addConstructor<>().freeze();
+    auto instance = gB.construct();
+
+    CHECK(allocations::count([&]() { CHECK(gB.data.get(methodKey)); }).allocations == 0);
+    CHECK(allocations::count([&]() { CHECK(instance.call<int>(methodKey, 1) == 2); }).allocations
+          == 0);
+  }
+
+  SUBCASE("inline calls") {
+    auto gA = createClass<A>().addConstructor<>().addMethod("method", &A::method);
+    auto instance = gA.construct();
+    CHECK(allocations::count([&]() { CHECK(instance.invoke(methodKey, 1).get<int>() == 2); })
+              .allocations
+          == 0);
+  }
+
+  SUBCASE("static class") {
+    auto map = createStaticClass<A>(bind::method("method", &A::method));
+    Instance instance(map, A());
+    // values and typed methods are created on first use
+    CHECK(map.get(methodKey));
+    CHECK(instance.call<int>(methodKey, 1) == 2);
+    CHECK(allocations::count([&]() { CHECK(map.get(methodKey)); }).allocations == 0);
+    CHECK(allocations::count([&]() { CHECK(instance.call<int>(methodKey, 1) == 2); }).allocations
+          == 0);
+  }
+
+  SUBCASE("field access") {
+    auto gA = createClass<A>().addConstructor<>().addMember("member", &A::member);
+    auto instance = gA.construct();
+    auto table = getFieldTable(gA.data);
+    REQUIRE(table);
+    CHECK(allocations::count([&]() {
+            auto field = table->find(memberKey);
+            CHECK(field->get<int>(table->getConstObject(*instance)) == 1);
+          }).allocations
+          == 0);
+  }
+}
@@ -0,0 +1,28 @@
+#include "allocations.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+  // counted per thread, so allocations of concurrently running threads don't affect budgets
+  thread_local size_t allocationCount = 0;
+  thread_local size_t allocationBytes = 0;
+
+  void *allocate(size_t size) {
+    ++allocationCount;
+    allocationBytes += size;
+    if (auto ptr = std::malloc(size == 0 ? 1 : size)) {
+      return ptr;
+    }
+    throw std::bad_alloc();
+  }
+}  // namespace
+
+allocations::Count allocations::current() { return Count{allocationCount, allocationBytes}; }
+
+void *operator new(size_t size) { return allocate(size); }
+void *operator new[](size_t size) { return allocate(size); }
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { std::free(ptr); }
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+
+namespace allocations {
+
+  /**
+   * Number and size of the heap allocations made by the current thread since it started.
+   * Counted through the global `operator new` replacement in `allocations.cpp`, which is also
+   * linked into the benchmarks.
+   */
+  struct Count {
+    size_t allocations = 0;
+    size_t bytes = 0;
+  };
+
+  Count current();
+
+  /**
+   * Returns the heap allocations made by the current thread while calling `f`, e.g.
+   * `CHECK(allocations::count([&]() { map.get(key); }).allocations == 0)`.
+   */
+  template <class F> Count count(F &&f) {
+    auto start = current();
+    f();
+    auto end = current();
+    return Count{end.allocations - start.allocations, end.bytes - start.bytes};
+  }
+
+}  // namespace allocations
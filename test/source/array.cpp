@@ -1,10 +1,18 @@
 #include <doctest/doctest.h>
 #include <glue/array.h>
 
+#include <list>
 #include <vector>
 
 using namespace glue;
 
+namespace {
+  struct Element {
+    explicit Element(int v) : value(v) {}
+    int value;
+  };
+}  // namespace
+
 TEST_CASE("Array") {
   auto arrayValue = glue::createArrayClass<std::vector<int>>();
   auto instance = arrayValue.construct();
@@ -32,3 +40,147 @@ TEST_CASE("Array") {
   CHECK_NOTHROW(instance["clear"]());
   CHECK(instance["size"]().as<int>() == 0);
 }
+
+TEST_CASE("Array bulk operations") {
+  auto instance = glue::createArrayClass<std::vector<int>>().construct();
+  instance["append"](std::vector<int>{1, 2, 3, 4});
+  CHECK(instance["size"]().as<int>() == 4);
+  CHECK(instance["getRange"](1, 2).get<std::vector<int>>() == std::vector<int>{2, 3});
+  CHECK(instance["getRange"](4, 0).get<std::vector<int>>().empty());
+  CHECK_THROWS(instance["getRange"](3, 2));
+  CHECK_THROWS(instance["getRange"](5, 0));
+  CHECK_NOTHROW(instance["setRange"](2, std::vector<int>{5, 6}));
+  CHECK_THROWS(instance["setRange"](3, std::vector<int>{7, 8}));
+  CHECK(instance->get<std::vector<int>>() == std::vector<int>{1, 2, 5, 6});
+  CHECK_NOTHROW(instance["reserve"](100));
+  CHECK(instance->get<const std::vector<int> &>().capacity() >= 100);
+  CHECK_NOTHROW(instance["resize"](6));
+  CHECK(instance["size"]().as<int>() == 6);
+
+  SUBCASE("itself") {
+    instance->get<std::vector<int> &>().shrink_to_fit();
+    instance["append"](instance);
+    CHECK(instance->get<std::vector<int>>()
+          == std::vector<int>{1, 2, 5, 6, 0, 0, 1, 2, 5, 6, 0, 0});
+    instance["setRange"](0, instance);
+    CHECK(instance["size"]().as<int>() == 12);
+  }
+
+  SUBCASE("buffer") {
+    auto buffer = instance["buffer"]().get<glue::ArrayBuffer>();
+    CHECK(buffer.size == 6);
+    CHECK(buffer.elementSize == sizeof(int));
+    CHECK(!buffer.as<float>());
+    REQUIRE(buffer.as<int>());
+    buffer.as<int>()[5] = 42;
+    CHECK(instance["get"](5).as<int>() == 42);
+  }
+
+  SUBCASE("non-contiguous") {
+    auto bools = glue::createArrayClass<std::vector<bool>>().construct();
+    CHECK(!bools.classMap["buffer"]);
+    bools["append"](std::vector<bool>{true, false});
+    CHECK(bools["getRange"](1, 1).get<std::vector<bool>>() == std::vector<bool>{false});
+  }
+
+  SUBCASE("non-default-constructible elements") {
+    auto elements = glue::createArrayClass<std::vector<Element>>().construct();
+    CHECK(!elements.classMap["resize"]);
+    elements["push"](Element(1));
+    CHECK(elements["get"](0).get<Element>().value == 1);
+  }
+}
+
+TEST_CASE("Array iteration") {
+  auto instance = glue::createArrayClass<std::vector<int>>().construct();
+  instance["append"](std::vector<int>{1, 2, 3, 4, 5});
+
+  SUBCASE("forEach") {
+    int sum = 0;
+    instance["forEach"]([&](int x) { sum += x; });
+    CHECK(sum == 15);
+  }
+
+  SUBCASE("cursor") {
+    auto cursorClass = glue::createCursorClass<std::vector<int>>();
+    auto cursor = glue::Instance(cursorClass.data, instance["cursor"]());
+    CHECK(cursor["next"]().get<int>() == 1);
+    CHECK(cursor["nextBatch"](3).get<std::vector<int>>() == std::vector<int>{2, 3, 4});
+    CHECK(!cursor["done"]().get<bool>());
+    CHECK(cursor["nextBatch"](3).get<std::vector<int>>() == std::vector<int>{5});
+    CHECK(cursor["done"]().get<bool>());
+    CHECK(cursor["nextBatch"](3).get<std::vector<int>>().empty());
+    CHECK_THROWS(cursor["next"]());
+  }
+
+  SUBCASE("cursor outliving the array") {
+    auto cursorClass = glue::createCursorClass<std::vector<int>>();
+    auto cursor = glue::Instance(cursorClass.data, instance["cursor"]());
+    instance = glue::Instance();
+    CHECK(cursor["nextBatch"](2).get<std::vector<int>>() == std::vector<int>{1, 2});
+  }
+
+  SUBCASE("cursor over a modified array") {
+    auto cursorClass = glue::createCursorClass<std::vector<int>>();
+    auto cursor = glue::Instance(cursorClass.data, instance["cursor"]());
+    CHECK(cursor["next"]().get<int>() == 1);
+    instance["reserve"](1000);
+    CHECK(cursor["next"]().get<int>() == 2);
+    instance["resize"](3);
+    CHECK(cursor["nextBatch"](3).get<std::vector<int>>() == std::vector<int>{3});
+    CHECK(cursor["done"]().get<bool>());
+    CHECK_THROWS(cursor["next"]());
+  }
+
+  SUBCASE("list") {
+    auto listClass = glue::createClass<std::list<int>>().addConstructor<>();
+    glue::addIterationMethods(listClass);
+    CHECK(!listClass.data["cursor"]);
+    auto list = listClass.construct();
+    list->get<std::list<int> &>() = {1, 2, 3};
+    int sum = 0;
+    list["forEach"]([&](int x) { sum += x; });
+    CHECK(sum == 6);
+  }
+}
+
+TEST_CASE("Array columns") {
+  struct Particle {
+    float x = 0, y = 0;
+    int id = 0;
+  };
+
+  auto particleClass = glue::createClass<Particle>()
+                           .addMember("x", &Particle::x)
+                           .addMember("y", &Particle::y)
+                           .addConstMember("id", &Particle::id);
+  auto arrayClass = glue::createArrayClass<std::vector<Particle>>();
+  glue::addColumnMethods(arrayClass, particleClass.data);
+  auto instance = arrayClass.construct();
+  auto &particles = instance->get<std::vector<Particle> &>();
+  for (int i = 0; i < 4; ++i) particles.push_back(Particle{float(i), float(2 * i), i});
+
+  CHECK(instance["getColumn"]("y").get<std::vector<float>>()
+        == std::vector<float>{0, 2, 4, 6});
+  CHECK(instance["getColumn"]("id").get<std::vector<int>>() == std::vector<int>{0, 1, 2, 3});
+  CHECK_THROWS(instance["getColumn"]("z"));
+  CHECK_THROWS(instance["getColumn"]("unknown column"));
+  CHECK(!glue::Key::find("unknown column"));
+
+  instance["setColumn"]("x", std::vector<float>{4, 3, 2, 1});
+  CHECK(particles[0].x == 4);
+  CHECK(particles[3].x == 1);
+  CHECK(particles[3].y == 6);
+  CHECK_THROWS(instance["setColumn"]("x", std::vector<float>{1}));
+  CHECK_THROWS(instance["setColumn"]("x", std::vector<int>{1, 2, 3, 4}));
+  CHECK_THROWS(instance["setColumn"]("id", std::vector<int>{1, 2, 3, 4}));
+
+  SUBCASE("mismatched element class") {
+    auto otherClass = glue::createClass<glue::ArrayBuffer>().addMember(
+        "size", &glue::ArrayBuffer::size);
+    auto otherArrayClass = glue::createArrayClass<std::vector<Particle>>();
+    glue::addColumnMethods(otherArrayClass, otherClass.data);
+    auto other = otherArrayClass.construct();
+    CHECK_THROWS(other["getColumn"]("size"));
+  }
+}
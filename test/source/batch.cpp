@@ -0,0 +1,76 @@
+#include <doctest/doctest.h>
+#include <glue/batch.h>
+#include <glue/class.h>
+
+#include <atomic>
+
+using namespace glue;
+
+namespace {
+
+  struct Body {
+    double position = 0, velocity = 1;
+    double update(double dt) {
+      position += velocity * dt;
+      return position;
+    }
+  };
+
+  struct Other {
+    double update(double) const { return -1; }
+  };
+
+}  // namespace
+
+TEST_CASE("Batched invocation") {
+  auto bodyClass = createClass<Body>().addConstructor<>().addMethod("update", &Body::update);
+  auto otherClass = createClass<Other>().addConstructor<>().addMethod("update", &Other::update);
+
+  std::vector<Instance> instances;
+  for (int i = 0; i < 10; ++i) {
+    instances.push_back(i % 5 == 4 ? otherClass.construct() : bodyClass.construct());
+  }
+
+  auto results = invokeAll(instances, "update", 0.5);
+  REQUIRE(results.size() == instances.size());
+  CHECK(results[0].get<double>() == 0.5);
+  CHECK(results[4].get<double>() == -1);
+  results = invokeAll(instances, "update", 0.5);
+  CHECK(results[3].get<double>() == 1);
+
+  SUBCASE("errors") {
+    CHECK_THROWS(invokeAll(instances, "missing"));
+    instances.emplace_back();
+    CHECK_THROWS(invokeAll(instances, "update", 0.5));
+  }
+
+  SUBCASE("parallel") {
+    std::vector<Instance> many;
+    for (int i = 0; i < 1000; ++i) many.push_back(bodyClass.construct());
+    std::vector<Any> output(many.size());
+    InvokeOptions options;
+    options.threads = 4;
+    options.minChunkSize = 100;
+    invokeAll(many.data(), many.size(), "update", {Any(2.0)}, output.data(), options);
+    invokeAll(many.data(), many.size(), "update", {Any(2.0)}, nullptr, options);
+    for (auto &instance : many) {
+      CHECK(instance->get<const Body &>().position == 4);
+    }
+    for (auto &result : output) {
+      CHECK(result.get<double>() == 2);
+    }
+  }
+
+  SUBCASE("parallel errors") {
+    std::atomic<int> calls{0};
+    auto throwing = createClass<Body>().addConstructor<>().addMethod("fail", [&](Body &) {
+      if (++calls == 50) throw std::runtime_error("failed");
+    });
+    std::vector<Instance> many;
+    for (int i = 0; i < 100; ++i) many.push_back(throwing.construct());
+    InvokeOptions options;
+    options.threads = 2;
+    options.minChunkSize = 10;
+    CHECK_THROWS(invokeAll(many.data(), many.size(), "fail", {}, nullptr, options));
+  }
+}
@@ -65,3 +65,167 @@ TEST_CASE("ClassValue") {
     CHECK(vb["anotherMethod"](*gB.construct("A"), "x").get<std::string>() == "BxA");
   }
 }
+
+TEST_CASE("BoundMethod") {
+  auto gA = glue::createClass<A>()
+                .addConstructor<>()
+                .addMethod("method", &A::method)
+                .addMember("member", &A::member);
+  auto a = gA.construct();
+
+  SUBCASE("call") {
+    auto method = a.method("method");
+    REQUIRE(method);
+    CHECK(method(1).get<int>() == 43);
+    CHECK(method(2).get<int>() == 44);
+    CHECK_NOTHROW(a.method("setMember")("x"));
+    CHECK(a.method("member")().get<std::string>() == "x");
+  }
+
+  SUBCASE("rebind") {
+    auto b = gA.construct();
+    auto setMember = a.method("setMember");
+    setMember("a");
+    setMember.rebind(b)("b");
+    CHECK(a["member"]().get<std::string>() == "a");
+    CHECK(b["member"]().get<std::string>() == "b");
+    auto other = glue::createClass<A>().addConstructor<>().construct();
+    CHECK_THROWS(setMember.rebind(other));
+  }
+
+  SUBCASE("temporary instance") {
+    auto method = gA.construct().method("method");
+    CHECK(method(1).get<int>() == 43);
+  }
+
+  SUBCASE("invalid") {
+    CHECK_THROWS(a.method("undefined"));
+    Instance empty;
+    CHECK_THROWS(empty.method("method"));
+    BoundMethod unbound;
+    CHECK(!unbound);
+    CHECK_THROWS(unbound());
+    CHECK_THROWS(unbound.rebind(a));
+  }
+}
+
+TEST_CASE("Typed calls") {
+  auto gA = glue::createClass<A>()
+                .addConstructor<>()
+                .addMethod("method", &A::method)
+                .addMethod("lambda", [](const A &a, const std::string &x) { return a.member + x; })
+                .addMember("member", &A::member);
+
+  auto gB = glue::createClass<B>(glue::WithBases<A>())
+                .setExtends(gA)
+                .addConstructor<std::string>()
+                .addMethod("anotherMethod", &B::anotherMethod)
+                .addValue("lambda", 42);
+
+  REQUIRE(gA.typedMethods->find("method"));
+  CHECK(gB.typedMethods->find("method") == gA.typedMethods->find("method"));
+  CHECK(!gB.typedMethods->find("lambda"));
+
+  SUBCASE("typed") {
+    auto a = gA.construct();
+    CHECK(a.call<int>("method", 1) == 43);
+    CHECK_NOTHROW(a.call<void>("setMember", std::string("x")));
+    CHECK(a.call<std::string>("member") == "x");
+    CHECK(a.call<std::string>("lambda", std::string("y")) == "xy");
+  }
+
+  SUBCASE("inherited") {
+    auto b = gB.construct("b");
+    CHECK(b.call<int>("method", 2) == 44);
+    CHECK(b.call<std::string>("member") == "b");
+    CHECK_THROWS(b.call<std::string>("lambda", std::string("y")));
+  }
+
+  SUBCASE("fallback") {
+    auto a = gA.construct();
+    CHECK(a.call<int>("method", 1.0) == 43);
+    CHECK_NOTHROW(a.call<void>("setMember", "x"));
+    CHECK(a.call<std::string>("member") == "x");
+    CHECK_THROWS(a.call<int>("undefined"));
+    Instance empty;
+    CHECK_THROWS(empty.call<int>("method", 1));
+  }
+
+  SUBCASE("entries replaced through the map") {
+    auto a = gA.construct();
+    auto b = gB.construct("b");
+    gA.data["method"] = [](const A &, int x) { return -x; };
+    CHECK(a.call<int>("method", 1) == -1);
+    CHECK(a.invoke("method", 1).get<int>() == -1);
+    CHECK(b.call<int>("method", 2) == -2);
+    gB.data["method"] = 5;
+    CHECK_THROWS(b.call<int>("method", 2));
+  }
+
+  SUBCASE("entries replaced twice") {
+    auto a = gA.construct();
+    for (int i = 0; i < 16; ++i) {
+      gA.data["method"] = [](const A &, int x) { return -x; };
+      gA.data["method"] = [](const A &, int x) { return 3 * x; };
+      CHECK(a.invoke("method", 1).get<int>() == 3);
+      CHECK(a.call<int>("method", 1) == 3);
+    }
+  }
+}
+
+TEST_CASE("Signature checked calls") {
+  glue::Value f = [](int x, const std::string &y) { return y + std::to_string(x); };
+  CHECK(f.call<std::string(int, const std::string &)>(1, "x") == "x1");
+  CHECK(f.call<std::string(int, std::string)>(2, "x") == "x2");
+  CHECK_THROWS(f.call<std::string(int)>(1));
+  CHECK_THROWS(f.call<int(int, std::string)>(1, "x"));
+  CHECK_THROWS(glue::Value().call<void()>());
+}
+
+TEST_CASE("Reference bindings") {
+  struct Mesh {
+    std::vector<int> vertices;
+    std::string name;
+    const std::vector<int> &getVertices() const { return vertices; }
+    std::string &getName() { return name; }
+  };
+
+  auto generator = glue::createClass<Mesh>()
+                       .addConstructor<>()
+                       .addMemberRef("vertices", &Mesh::vertices)
+                       .addMethodRef("constVertices", &Mesh::getVertices)
+                       .addMethodRef("name", &Mesh::getName);
+  auto instance = generator.construct();
+  auto &mesh = instance->get<Mesh &>();
+  mesh.vertices = {1, 2, 3};
+
+  SUBCASE("member") {
+    auto vertices = instance["vertices"]();
+    CHECK(&vertices.get<const std::vector<int> &>() == &mesh.vertices);
+    vertices.get<std::vector<int> &>().push_back(4);
+    CHECK(mesh.vertices.size() == 4);
+    instance["setVertices"](std::vector<int>{5});
+    CHECK(mesh.vertices == std::vector<int>{5});
+  }
+
+  SUBCASE("methods") {
+    CHECK(&instance["constVertices"]().get<const std::vector<int> &>() == &mesh.vertices);
+    instance["name"]().get<std::string &>() = "mesh";
+    CHECK(mesh.name == "mesh");
+  }
+
+  SUBCASE("lifetime") {
+    auto vertices = instance["vertices"]();
+    instance = glue::Instance();
+    CHECK(vertices.get<const std::vector<int> &>() == std::vector<int>{1, 2, 3});
+  }
+
+  SUBCASE("const instance") {
+    glue::Instance constInstance(instance.classMap,
+                                 std::shared_ptr<const Mesh>(std::make_shared<Mesh>(mesh)));
+    auto vertices = constInstance["vertices"]();
+    CHECK(vertices.get<const std::vector<int> &>().size() == 3);
+    CHECK(!vertices.getShared<std::vector<int>>());
+    CHECK_THROWS(constInstance["name"]());
+  }
+}
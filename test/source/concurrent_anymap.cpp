@@ -0,0 +1,52 @@
+#include <doctest/doctest.h>
+#include <glue/concurrent_anymap.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace glue;
+
+TEST_CASE("ConcurrentAnyMap") {
+  auto map = createConcurrentMap();
+  CHECK(!map["a"]);
+
+  SUBCASE("single threaded") {
+    map["a"] = 1;
+    map["b"] = 2;
+    map["a"] = 3;
+    CHECK(map["a"]->get<int>() == 3);
+    CHECK(map["b"]->get<int>() == 2);
+    CHECK(map.keys().size() == 2);
+  }
+
+  SUBCASE("concurrent readers and writer") {
+    const int N = 200;
+    Key key = "value";
+    auto base = createConcurrentMap();
+    base[key] = 0;
+    map.setExtends(base);
+
+    std::atomic<bool> done{false};
+    std::atomic<bool> ordered{true};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+      readers.emplace_back([&]() {
+        int last = 0;
+        while (!done) {
+          auto value = map.get(key)->get<int>();
+          if (value < last) ordered = false;
+          last = value;
+        }
+      });
+    }
+    for (int i = 1; i <= N; ++i) {
+      base[key] = i;
+    }
+    done = true;
+    for (auto &&reader : readers) reader.join();
+
+    CHECK(ordered);
+    CHECK(map[key]->get<int>() == N);
+  }
+}
@@ -67,3 +67,174 @@ TEST_CASE("Context") {
     }
   }
 }
+
+namespace {
+  template <size_t N> struct Numbered {};
+
+  template <size_t... N>
+  void addNumberedClasses(glue::MapValue &root, std::index_sequence<N...>) {
+    ((root["C" + std::to_string(N)]
+      = glue::createClass<Numbered<N>>().template addConstructor<>()),
+     ...);
+  }
+}  // namespace
+
+TEST_CASE("Context type table") {
+  auto root = glue::createAnyMap();
+  addNumberedClasses(root, std::make_index_sequence<100>());
+
+  glue::Context context;
+  context.addRootMap(root);
+  context.addRootMap(root);
+
+  CHECK(context.types.size() == 400);
+  CHECK(context.uniqueTypes.size() == 100);
+  REQUIRE(context.getTypeInfo(glue::getTypeIndex<Numbered<42>>()));
+  CHECK(context.getTypeInfo(glue::getTypeIndex<Numbered<42>>())->path
+        == glue::Context::Path{"C42"});
+  CHECK(context.getTypeInfo(glue::getTypeIndex<const Numbered<7>>())
+        == context.getTypeInfo(glue::getTypeIndex<std::shared_ptr<Numbered<7>>>()));
+  CHECK(!context.getTypeInfo(glue::getTypeIndex<Numbered<100>>()));
+  CHECK(context.createInstance(glue::Value(Numbered<99>())));
+}
+
+TEST_CASE("Context modules") {
+  auto moduleA = glue::createAnyMap();
+  addNumberedClasses(moduleA, std::make_index_sequence<40>());
+  auto moduleB = glue::createAnyMap();
+  moduleB["A"] = glue::createClass<A>().addConstructor<>();
+
+  glue::Context context;
+  context.addModule({"a"}, moduleA);
+  context.addModule({"b", "inner"}, moduleB);
+
+  CHECK(context.uniqueTypes.size() == 41);
+  REQUIRE(context.getTypeInfo(glue::getTypeIndex<A>()));
+  CHECK(context.getTypeInfo(glue::getTypeIndex<A>())->path
+        == glue::Context::Path{"b", "inner", "A"});
+  CHECK(context.getTypeInfo(glue::getTypeIndex<Numbered<3>>())->path
+        == glue::Context::Path{"a", "C3"});
+
+  SUBCASE("remove") {
+    CHECK(context.removeModule({"a"}));
+    CHECK(!context.removeModule({"a"}));
+    CHECK(context.types.size() == 4);
+    CHECK(context.uniqueTypes.size() == 1);
+    CHECK(!context.getTypeInfo(glue::getTypeIndex<Numbered<3>>()));
+    CHECK(!context.getTypeInfo(glue::getTypeIndex<std::shared_ptr<const Numbered<3>>>()));
+    REQUIRE(context.getTypeInfo(glue::getTypeIndex<std::shared_ptr<A>>()));
+    CHECK(context.getTypeInfo(glue::getTypeIndex<std::shared_ptr<A>>())->path
+          == glue::Context::Path{"b", "inner", "A"});
+  }
+
+  SUBCASE("partial remove") {
+    auto reduced = glue::createAnyMap();
+    addNumberedClasses(reduced, std::make_index_sequence<20>());
+    context.addModule({"a"}, reduced);
+    CHECK(context.uniqueTypes.size() == 21);
+    CHECK(context.types.size() == 21 * 4);
+    for (auto &&[type, info] : context.types) {
+      CHECK(context.getTypeInfo(type) == &info);
+      CHECK(context.getTypeInfo(info.classInfo->sharedConstTypeID.index) == &info);
+    }
+    for (auto &&typeID : context.uniqueTypes) {
+      REQUIRE(context.getTypeInfo(typeID.index));
+      CHECK(context.getTypeInfo(typeID.index)->classInfo->typeID == typeID);
+    }
+    CHECK(context.getTypeInfo(glue::getTypeIndex<Numbered<19>>()));
+    CHECK(!context.getTypeInfo(glue::getTypeIndex<Numbered<20>>()));
+  }
+
+  SUBCASE("replaced by another module") {
+    context.addModule({"c"}, moduleB);
+    CHECK(context.removeModule({"b", "inner"}));
+    REQUIRE(context.getTypeInfo(glue::getTypeIndex<A>()));
+    CHECK(context.getTypeInfo(glue::getTypeIndex<A>())->path == glue::Context::Path{"c", "A"});
+  }
+
+  SUBCASE("shared by modules") {
+    context.addModule({"c"}, moduleB);
+    CHECK(context.removeModule({"c"}));
+    REQUIRE(context.getTypeInfo(glue::getTypeIndex<A>()));
+    CHECK(context.getTypeInfo(glue::getTypeIndex<A>())->path
+          == glue::Context::Path{"b", "inner", "A"});
+    CHECK(context.removeModule({"b", "inner"}));
+    CHECK(!context.getTypeInfo(glue::getTypeIndex<A>()));
+  }
+
+  SUBCASE("registered by a root map") {
+    glue::Context other;
+    auto root = glue::createAnyMap();
+    root["A"] = moduleB["A"];
+    other.addRootMap(root);
+    other.addModule({"m"}, moduleB);
+    CHECK(other.getTypeInfo(glue::getTypeIndex<A>())->path == glue::Context::Path{"m", "A"});
+    CHECK(other.removeModule({"m"}));
+    REQUIRE(other.getTypeInfo(glue::getTypeIndex<A>()));
+    CHECK(other.getTypeInfo(glue::getTypeIndex<A>())->path == glue::Context::Path{"A"});
+    CHECK(other.uniqueTypes.size() == 1);
+
+    other.addModule({"m"}, moduleB);
+    other.addRootMap(root);
+    CHECK(other.removeModule({"m"}));
+    REQUIRE(other.getTypeInfo(glue::getTypeIndex<A>()));
+    CHECK(other.getTypeInfo(glue::getTypeIndex<A>())->path == glue::Context::Path{"A"});
+  }
+
+  SUBCASE("reused entries") {
+    for (int i = 0; i < 10; ++i) {
+      CHECK(context.removeModule({"a"}));
+      context.addModule({"a"}, moduleA);
+    }
+    CHECK(context.uniqueTypes.size() == 41);
+    CHECK(context.types.size() == 41 * 4);
+    REQUIRE(context.getTypeInfo(glue::getTypeIndex<std::shared_ptr<Numbered<39>>>()));
+    CHECK(context.getTypeInfo(glue::getTypeIndex<std::shared_ptr<Numbered<39>>>())->path
+          == glue::Context::Path{"a", "C39"});
+    CHECK(context.getTypeInfo(glue::getTypeIndex<A>())->path
+          == glue::Context::Path{"b", "inner", "A"});
+  }
+
+  SUBCASE("copy") {
+    auto copy = context;
+    context.addModule({"c"}, moduleB);
+    CHECK(copy.removeModule({"b", "inner"}));
+    CHECK(!copy.getTypeInfo(glue::getTypeIndex<A>()));
+    CHECK(copy.uniqueTypes.size() == 40);
+    CHECK(context.removeModule({"c"}));
+    REQUIRE(context.getTypeInfo(glue::getTypeIndex<A>()));
+    CHECK(context.getTypeInfo(glue::getTypeIndex<A>())->path
+          == glue::Context::Path{"b", "inner", "A"});
+  }
+
+  SUBCASE("order") {
+    auto order = context.uniqueTypes;
+    CHECK(context.removeModule({"b", "inner"}));
+    order.pop_back();
+    CHECK(context.uniqueTypes == order);
+    context.addModule({"b"}, moduleB);
+    context.removeModule({"a"});
+    REQUIRE(context.uniqueTypes.size() == 1);
+    CHECK(context.uniqueTypes[0] == glue::getTypeID<A>());
+  }
+
+  SUBCASE("types") {
+    auto &types = context.types;
+    CHECK(types.size() == 41 * 4);
+    CHECK(types[glue::getTypeIndex<std::shared_ptr<const A>>()].path
+          == glue::Context::Path{"b", "inner", "A"});
+    auto it = types.find(glue::getTypeIndex<const A>());
+    REQUIRE(it != types.end());
+    CHECK(it->first == glue::getTypeIndex<const A>());
+    CHECK(it->second.classInfo->typeID == glue::getTypeID<A>());
+    CHECK(types.count(glue::getTypeIndex<A>()) == 1);
+    CHECK(types.find(glue::getTypeIndex<int>()) == types.end());
+    CHECK(types.count(glue::getTypeIndex<int>()) == 0);
+    CHECK_THROWS_AS(types.at(glue::getTypeIndex<int>()), std::out_of_range);
+    size_t count = 0;
+    for (auto it = types.begin(); it != types.end(); ++it) {
+      if (it->second.path == glue::Context::Path{"b", "inner", "A"}) ++count;
+    }
+    CHECK(count == 4);
+  }
+}
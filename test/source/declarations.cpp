@@ -2,6 +2,7 @@
 #include <glue/context.h>
 #include <glue/declarations.h>
 #include <glue/enum.h>
+#include <glue/lazy_map.h>
 #include <glue/value.h>
 
 #include <regex>
@@ -11,6 +12,7 @@ namespace {
 
   struct A {
     std::string member;
+    const std::string &getMember() const { return member; }
   };
 
   struct B : public A {
@@ -36,6 +38,8 @@ TEST_CASE("Declarations") {
       = glue::createClass<A>()
             .addConstructor<>()
             .addMember("member", &A::member)
+            .addMemberRef("memberRef", &A::member)
+            .addMethodRef("getMember", &A::getMember)
             .addMethod("staticMethod", [](int x) { return x * 0.5f; })
             .addMethod("variadicMethod", [](const glue::AnyArguments &args) { return args.size(); })
             .addMethod("sharedMethod", [](const std::shared_ptr<A> &a, const std::string &other) {
@@ -96,4 +100,81 @@ TEST_CASE("Declarations") {
             "const takesCallback: (this: void, arg0: (this: void, ...args: any[]) => any) => any")
         != std::string::npos);
   CHECK(declarations.find("constructor(...args: any[])") != std::string::npos);
+  CHECK(declarations.find("memberRef(): any") != std::string::npos);
+  CHECK(declarations.find("getMember(): any") != std::string::npos);
+  CHECK(declarations.find("static memberRef") == std::string::npos);
+  CHECK(declarations.find("static getMember") == std::string::npos);
+
+  SUBCASE("parallel") {
+    for (size_t i = 0; i < 20; ++i) {
+      auto module = glue::createAnyMap();
+      module["value"] = int(i);
+      module["C"] = glue::createClass<F>().addConstructor<>();
+      module["f"] = [](const B &b) { return b; };
+      root["module" + std::to_string(i)] = module;
+    }
+    std::stringstream serial;
+    printer.print(serial, root, &context);
+    printer.threads = 4;
+    std::stringstream parallel;
+    printer.print(parallel, root, &context);
+    CHECK(parallel.str() == serial.str());
+    CHECK(serial.str().find("declare module module19 {") != std::string::npos);
+  }
+
+  SUBCASE("cache") {
+    glue::DeclarationCache cache;
+    std::stringstream first;
+    printer.print(first, root, &context, cache);
+    CHECK(first.str() == stream.str().substr(1, stream.str().size() - 2));
+    CHECK(cache.reprinted == 4);
+
+    std::stringstream stored;
+    cache.save(stored);
+    glue::DeclarationCache loaded;
+    REQUIRE(loaded.load(stored));
+    CHECK(loaded.entries.size() == 4);
+
+    inner["createA"] = []() { return A(); };
+    std::stringstream second;
+    printer.print(second, root, &context, loaded);
+    CHECK(loaded.reprinted == 1);
+    CHECK(second.str().find("const createA: (this: void) => inner.A") != std::string::npos);
+
+    std::stringstream serial;
+    printer.print(serial, root, &context);
+    CHECK(second.str() == serial.str());
+
+    std::stringstream invalid("glue declaration cache 1\n1\n3 abc");
+    CHECK(!loaded.load(invalid));
+    CHECK(loaded.entries.empty());
+    std::stringstream oversized("glue declaration cache 1\n1\n18446744073709551615 abc");
+    CHECK(!loaded.load(oversized));
+    CHECK(loaded.entries.empty());
+  }
+
+  SUBCASE("cache after a failed print") {
+    glue::DeclarationCache cache;
+    std::stringstream first;
+    printer.print(first, root, &context, cache);
+
+    bool fail = true;
+    auto lazy = std::make_shared<glue::LazyMap>();
+    lazy->setFactory("value", [&]() {
+      if (fail) throw std::runtime_error("failed");
+      return 1;
+    });
+    auto failing = glue::createAnyMap();
+    failing["lazy"] = glue::MapValue(lazy);
+    root["zzz"] = failing;
+    std::stringstream second;
+    CHECK_THROWS(printer.print(second, root, &context, cache));
+
+    fail = false;
+    std::stringstream third;
+    printer.print(third, root, &context, cache);
+    std::stringstream serial;
+    printer.print(serial, root, &context);
+    CHECK(third.str() == serial.str());
+  }
 }
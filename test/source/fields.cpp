@@ -0,0 +1,119 @@
+#include <doctest/doctest.h>
+#include <glue/class.h>
+#include <glue/fields.h>
+
+using namespace glue;
+
+namespace {
+
+  struct Point {
+    float x = 0, y = 0;
+    int id = 0;
+    std::string label;
+  };
+
+  struct NonStandard {
+    virtual ~NonStandard() {}
+    int value = 0;
+  };
+
+  struct NoDefault {
+    explicit NoDefault(int v) : value(v) {}
+    int value;
+  };
+
+  struct Unsupported {
+    const int constant = 1;
+    float vector[3] = {};
+    NoDefault noDefault{2};
+  };
+
+}  // namespace
+
+TEST_CASE("Fields") {
+  auto generator = createClass<Point>()
+                       .addConstructor<>()
+                       .addMember("x", &Point::x)
+                       .addMember("y", &Point::y)
+                       .addConstMember("id", &Point::id)
+                       .addMember("label", &Point::label);
+
+  auto table = getFieldTable(generator.data);
+  REQUIRE(table);
+  CHECK(table->fields.size() == 3);
+  CHECK(!table->find("label"));
+  auto x = table->find("x");
+  auto y = table->find("y");
+  auto id = table->find("id");
+  REQUIRE(x);
+  REQUIRE(y);
+  REQUIRE(id);
+  CHECK(x->offset == offsetof(Point, x));
+  CHECK(y->offset == offsetof(Point, y));
+  CHECK(id->size == sizeof(int));
+  CHECK(id->readOnly);
+  CHECK(!x->readOnly);
+
+  auto instance = generator.construct();
+  auto &point = instance->get<Point &>();
+  point.x = 1;
+  point.y = 2;
+  point.id = 3;
+
+  SUBCASE("direct access") {
+    CHECK(x->get<float>(&point) == 1);
+    x->get<float>(static_cast<void *>(&point)) = 4;
+    CHECK(point.x == 4);
+    CHECK_THROWS(x->get<int>(&point));
+    CHECK_THROWS(id->get<int>(static_cast<void *>(&point)));
+  }
+
+  SUBCASE("bulk access") {
+    struct {
+      float y, x;
+      int id;
+    } values;
+    static_assert(sizeof(values) == 12);
+    readFields(instance, {"y", "x", "id"}, &values);
+    CHECK(values.x == 1);
+    CHECK(values.y == 2);
+    CHECK(values.id == 3);
+    float update[2] = {5, 6};
+    writeFields(instance, {"x", "y"}, update);
+    CHECK(point.x == 5);
+    CHECK(point.y == 6);
+    CHECK_THROWS(writeFields(instance, {"x", "id"}, &values));
+    CHECK_THROWS(writeFields(instance, {"x", "label"}, &values));
+    CHECK_THROWS(readFields(instance, {"label"}, &values));
+    CHECK(point.x == 5);
+  }
+
+  SUBCASE("const instance") {
+    Instance constInstance(generator.data, std::make_shared<const Point>(point));
+    float value = 0;
+    readFields(constInstance, {"x"}, &value);
+    CHECK(value == 1);
+    CHECK_THROWS(writeFields(constInstance, {"x"}, &value));
+  }
+
+  SUBCASE("overridden member") {
+    generator.addMethod("x", [](const Point &p) { return p.x * 2; });
+    CHECK(!table->find("x"));
+    CHECK(table->find("y"));
+  }
+
+  SUBCASE("non-standard layout") {
+    auto nonStandard = createClass<NonStandard>().addMember("value", &NonStandard::value);
+    CHECK(!getFieldTable(nonStandard.data));
+  }
+
+  SUBCASE("unsupported members") {
+    auto unsupported = createClass<Unsupported>()
+                           .addConstMember("constant", &Unsupported::constant)
+                           .addConstMember("vector", &Unsupported::vector)
+                           .addMember("noDefault", &Unsupported::noDefault);
+    CHECK(unsupported.data["constant"]);
+    CHECK(unsupported.data["setNoDefault"]);
+    CHECK(!getFieldTable(unsupported.data));
+  }
+}
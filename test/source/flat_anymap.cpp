@@ -0,0 +1,83 @@
+#include <doctest/doctest.h>
+#include <glue/class.h>
+#include <glue/enum.h>
+#include <glue/flat_anymap.h>
+
+#include <algorithm>
+
+using namespace glue;
+
+namespace {
+
+  struct A {
+    int member = 0;
+    int method(int x) const { return member + x; }
+  };
+
+  enum class E { A, B };
+
+}  // namespace
+
+TEST_CASE("FlatAnyMap") {
+  FlatAnyMap map;
+  CHECK(!map.get("a"));
+
+  SUBCASE("small") {
+    map.set("a", 1);
+    map.set("b", 2);
+    map.set("a", 3);
+    CHECK(map.size() == 2);
+    CHECK(map.get("a").get<int>() == 3);
+    CHECK(map.get("b").get<int>() == 2);
+    CHECK(!map.get("c"));
+  }
+
+  SUBCASE("large") {
+    const int N = 1000;
+    for (int i = 0; i < N; ++i) {
+      map.set("key" + std::to_string(i), i);
+    }
+    CHECK(map.size() == N);
+    for (int i = 0; i < N; ++i) {
+      CHECK(map.get("key" + std::to_string(i)).get<int>() == i);
+    }
+    CHECK(!map.get("key" + std::to_string(N)));
+    map.set("key42", -1);
+    CHECK(map.size() == N);
+    CHECK(map.get("key42").get<int>() == -1);
+  }
+
+  SUBCASE("reserve") {
+    map.set("a", 1);
+    map.reserve(100);
+    map.set("b", 2);
+    CHECK(map.get("a").get<int>() == 1);
+    CHECK(map.get("b").get<int>() == 2);
+  }
+
+  SUBCASE("forEach") {
+    map.set("a", 1);
+    map.set("b", 2);
+    std::vector<std::string> keys;
+    map.forEach([&](auto &&key) {
+      keys.push_back(key);
+      return false;
+    });
+    CHECK(keys == std::vector<std::string>{"a", "b"});
+  }
+}
+
+TEST_CASE("Flat class and enum maps") {
+  auto gA = createClass<A>(WithBases<>(), createFlatMap())
+                .addConstructor<>()
+                .addMethod("method", &A::method)
+                .addMember("member", &A::member);
+  CHECK(std::dynamic_pointer_cast<FlatAnyMap>(gA.data.data));
+  auto a = gA.construct();
+  CHECK_NOTHROW(a["setMember"](2));
+  CHECK(a["method"](3).get<int>() == 5);
+
+  MapValue e = createEnum<E>(createFlatMap()).addValue("A", E::A).addValue("B", E::B);
+  CHECK(std::dynamic_pointer_cast<FlatAnyMap>(e.data));
+  CHECK(e["B"]->get<E>() == E::B);
+}
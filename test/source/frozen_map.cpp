@@ -0,0 +1,108 @@
+#include <doctest/doctest.h>
+#include <glue/class.h>
+#include <glue/frozen_map.h>
+
+#include <algorithm>
+
+using namespace glue;
+
+namespace {
+
+  struct A {
+    int member = 0;
+    int method(int x) const { return member + x; }
+  };
+
+  struct B : public A {
+    int other() const { return 2 * member; }
+  };
+
+}  // namespace
+
+TEST_CASE("FrozenMap") {
+  auto map = createAnyMap();
+
+  SUBCASE("empty") {
+    auto frozen = createFrozenMap(map);
+    CHECK(!frozen["a"]);
+    CHECK(frozen.keys().empty());
+  }
+
+  SUBCASE("entries") {
+    const int N = 500;
+    for (int i = 0; i < N; ++i) {
+      map["key" + std::to_string(i)] = i;
+    }
+    auto frozen = createFrozenMap(map);
+    CHECK(frozen.keys().size() == N);
+    for (int i = 0; i < N; ++i) {
+      CHECK(frozen["key" + std::to_string(i)]->get<int>() == i);
+    }
+    CHECK(!frozen["key" + std::to_string(N)]);
+    CHECK_THROWS(frozen["key0"] = 1);
+  }
+
+  SUBCASE("inherited entries") {
+    auto base = createAnyMap();
+    base["a"] = 1;
+    base["b"] = 2;
+    map["b"] = 3;
+    map.setExtends(base);
+    auto frozen = createFrozenMap(map);
+    CHECK(frozen.rawGet("a")->get<int>() == 1);
+    CHECK(frozen["a"]->get<int>() == 1);
+    CHECK(frozen["b"]->get<int>() == 3);
+    auto keys = frozen.keys();
+    std::sort(keys.begin(), keys.end());
+    CHECK(keys == std::vector<std::string>{"__glue_extends", "b"});
+  }
+
+  SUBCASE("sizes") {
+    for (int n = 1; n < 64; ++n) {
+      std::vector<FrozenMap::Entry> entries;
+      for (int i = 0; i < n; ++i) {
+        entries.push_back(FrozenMap::Entry{"s" + std::to_string(i), i, false});
+      }
+      FrozenMap frozen(entries);
+      CHECK(frozen.size() == size_t(n));
+      size_t count = 0;
+      frozen.forEach([&](auto &&) {
+        ++count;
+        return false;
+      });
+      CHECK(count == size_t(n));
+      for (int i = 0; i < n; ++i) {
+        CHECK(frozen.get("s" + std::to_string(i)).get<int>() == i);
+      }
+    }
+  }
+
+  SUBCASE("duplicate keys") {
+    std::vector<FrozenMap::Entry> entries{{"a", 1, false}, {"a", 2, false}};
+    CHECK_THROWS(FrozenMap(entries));
+  }
+}
+
+TEST_CASE("Frozen class") {
+  auto gA = createClass<A>()
+                .addConstructor<>()
+                .addMethod("method", &A::method)
+                .addMember("member", &A::member)
+                .freeze();
+  auto gB = createClass<B>(WithBases<A>())
+                .setExtends(gA)
+                .addConstructor<>()
+                .addMethod("other", &B::other)
+                .freeze();
+
+  REQUIRE(std::dynamic_pointer_cast<FrozenMap>(gA.data.data));
+  REQUIRE(getClassInfo(gB.data));
+  CHECK(getClassInfo(gB.data)->typeID == getTypeID<B>());
+  CHECK_THROWS(gA.addMethod("x", [](const A &) {}));
+
+  auto b = gB.construct();
+  CHECK_NOTHROW(b["setMember"](2));
+  CHECK(b["method"](1).get<int>() == 3);
+  CHECK(b["other"]().get<int>() == 4);
+  CHECK(b.call<int>("method", 1) == 3);
+}
@@ -0,0 +1,90 @@
+#include <doctest/doctest.h>
+#include <glue/class.h>
+
+#include <limits>
+#include <string>
+
+using namespace glue;
+
+namespace {
+
+  struct A {
+    int member = 1;
+    double scale(double x, int y) const { return member * x * y; }
+    std::string name(std::string_view prefix) const { return std::string(prefix) + "A"; }
+    bool positive() const { return member > 0; }
+  };
+
+}  // namespace
+
+TEST_CASE("InlineValue") {
+  SUBCASE("storage") {
+    CHECK(!InlineValue());
+    CHECK(InlineValue(1).isInline());
+    CHECK(InlineValue(1).get<int>() == 1);
+    CHECK(InlineValue(1).get<double>() == 1);
+    CHECK(InlineValue(2.5).get<double>() == 2.5);
+    CHECK(InlineValue(true).get<bool>());
+    CHECK(InlineValue(true).convertsInline<bool>());
+    CHECK(!InlineValue(1).convertsInline<bool>());
+    CHECK(InlineValue(1).convertsInline<float>());
+    CHECK(InlineValue(2.0).convertsInline<int>());
+    CHECK(!InlineValue(1.7).convertsInline<int>());
+    CHECK(!InlineValue(int64_t(1) << 40).convertsInline<int>());
+    CHECK(!InlineValue(-1).convertsInline<unsigned>());
+    CHECK(!InlineValue(1e20).convertsInline<int64_t>());
+    CHECK(!InlineValue((int64_t(1) << 60) + 1).convertsInline<double>());
+    CHECK(InlineValue(int64_t(1) << 60).convertsInline<double>());
+    CHECK(!InlineValue(0.1).convertsInline<float>());
+    CHECK(InlineValue(0.5).convertsInline<float>());
+    CHECK(!InlineValue(std::numeric_limits<uint64_t>::max()).isInline());
+    CHECK(InlineValue(std::numeric_limits<uint64_t>::max()).get<uint64_t>()
+          == std::numeric_limits<uint64_t>::max());
+    CHECK(InlineValue("x").get<std::string_view>() == "x");
+    std::string s = "text";
+    CHECK(InlineValue(s).isInline());
+    CHECK(InlineValue(s).get<std::string>() == "text");
+    CHECK(InlineValue(s).convertsInline<std::string>());
+    CHECK(!InlineValue(s).convertsInline<const std::string &>());
+    CHECK_THROWS(InlineValue(s).get<const std::string &>());
+    CHECK(!InlineValue(std::string("temporary")).isInline());
+    CHECK(InlineValue(std::string("temporary")).get<const std::string &>() == "temporary");
+    CHECK(!InlineValue(A()).isInline());
+    CHECK(InlineValue(A()).get<const A &>().member == 1);
+  }
+
+  SUBCASE("boxing") {
+    CHECK(InlineValue(3).toAny().get<int>() == 3);
+    CHECK(InlineValue("x").toAny().get<std::string>() == "x");
+    CHECK(!InlineValue().toAny());
+    CHECK(Value(InlineValue(2.0))->get<double>() == 2);
+  }
+
+  SUBCASE("calls") {
+    auto gA = createClass<A>()
+                  .addConstructor<>()
+                  .addMethod("scale", &A::scale)
+                  .addMethod("name", &A::name)
+                  .addMethod("positive", &A::positive)
+                  .addMember("member", &A::member)
+                  .addMethod("add", [](const A &a, const A &b) { return a.member + b.member; });
+    auto a = gA.construct();
+
+    auto result = a.invoke("scale", 2, 3.0);
+    CHECK(result.isInline());
+    CHECK(result.get<double>() == 6);
+    CHECK(a.invoke("positive").get<bool>());
+    CHECK(a.invoke("name", "B").get<std::string>() == "BA");
+    a.invoke("setMember", 2);
+    CHECK(a.invoke("member").get<int>() == 2);
+
+    // arguments that can't be passed inline fall back to boxed calls
+    CHECK(a.invoke("scale", true, 1).get<double>() == 2);
+    // as do numbers that would be narrowed
+    CHECK(!a.invoke("scale", 1, 1.5).isInline());
+    CHECK(a.invoke("scale", 1.5, 2.0).isInline());
+    CHECK(a.invoke("add", A()).get<int>() == 3);
+    CHECK_THROWS(a.invoke("missing"));
+    CHECK_THROWS(Instance().invoke("scale", 1, 1));
+  }
+}
@@ -0,0 +1,83 @@
+#include <doctest/doctest.h>
+#include <glue/key.h>
+#include <glue/keys.h>
+#include <glue/value.h>
+
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+using namespace glue;
+
+TEST_CASE("Key") {
+  Key a = "a";
+  Key b = std::string("b");
+
+  CHECK(a.str() == "a");
+  CHECK(b.str() == "b");
+  CHECK(a != b);
+  CHECK(a < b);
+  CHECK(Key() == Key(""));
+
+  SUBCASE("interned") {
+    Key a2 = std::string("a");
+    CHECK(a == a2);
+    CHECK(&a.str() == &a2.str());
+    CHECK(a.hash() == a2.hash());
+    CHECK(std::hash<Key>()(a) == a.hash());
+  }
+
+  SUBCASE("internal keys") {
+    CHECK(keys::constructorKey == Key("__new"));
+    CHECK(keys::operators::eq.str() == "__eq");
+  }
+
+  SUBCASE("hash set") {
+    std::unordered_set<Key> set{a, b, "a"};
+    CHECK(set.size() == 2);
+    CHECK(set.count("b") == 1);
+    CHECK(set.count("c") == 0);
+  }
+
+  SUBCASE("map access") {
+    auto map = createAnyMap();
+    map[a] = 1;
+    CHECK(map["a"]->as<int>() == 1);
+    CHECK(map[a]->as<int>() == 1);
+    CHECK(!map[b]);
+    CHECK(map.find("a"));
+    CHECK(!map.find("never interned key"));
+  }
+
+  SUBCASE("find") {
+    CHECK(!Key::find("never interned key"));
+    CHECK(!Key::find("never interned key"));
+    CHECK(Key::find("a") == a);
+    Key c("found key");
+    CHECK(Key::find("found key") == c);
+  }
+
+  SUBCASE("many keys") {
+    std::vector<Key> keys;
+    for (int i = 0; i < 10000; ++i) keys.emplace_back("many key " + std::to_string(i));
+    size_t mismatches = 0;
+    for (int i = 0; i < 10000; ++i) {
+      auto name = "many key " + std::to_string(i);
+      if (Key(name) != keys[i] || Key::find(name) != keys[i]) ++mismatches;
+    }
+    CHECK(mismatches == 0);
+  }
+
+  SUBCASE("threads") {
+    std::vector<const void *> ids(4);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < ids.size(); ++i) {
+      threads.emplace_back([&, i]() {
+        for (int j = 0; j < 100; ++j) Key("thread key " + std::to_string(j));
+        ids[i] = Key("thread key 7").id();
+      });
+    }
+    for (auto &thread : threads) thread.join();
+    for (auto id : ids) CHECK(id == Key("thread key 7").id());
+  }
+}
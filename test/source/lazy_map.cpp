@@ -0,0 +1,149 @@
+#include <doctest/doctest.h>
+#include <glue/class.h>
+#include <glue/context.h>
+#include <glue/lazy_map.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+using namespace glue;
+
+namespace {
+
+  struct A {
+    int member = 0;
+    int method(int x) const { return member + x; }
+  };
+
+}  // namespace
+
+TEST_CASE("LazyMap") {
+  auto lazy = std::make_shared<LazyMap>();
+  MapValue map(lazy);
+  int created = 0;
+
+  lazy->setFactory("A", [&]() {
+    ++created;
+    return createClass<A>().addConstructor<>().addMethod("method", &A::method);
+  });
+  lazy->setFactory("f", [&]() {
+    ++created;
+    return [](int x) { return 2 * x; };
+  });
+  map["x"] = 3;
+
+  SUBCASE("enumeration does not materialize") {
+    auto keys = map.keys();
+    std::sort(keys.begin(), keys.end());
+    CHECK(keys == std::vector<std::string>{"A", "f", "x"});
+    CHECK(created == 0);
+    CHECK(!lazy->isMaterialized("A"));
+    CHECK(lazy->isMaterialized("x"));
+    CHECK(!lazy->isMaterialized("y"));
+  }
+
+  SUBCASE("materialize on get") {
+    CHECK(map["f"](2)->get<int>() == 4);
+    CHECK(created == 1);
+    CHECK(lazy->isMaterialized("f"));
+    CHECK(!lazy->isMaterialized("A"));
+    CHECK(map["A"][keys::constructorKey]());
+    CHECK(created == 2);
+    CHECK(map["f"](3)->get<int>() == 6);
+    CHECK(created == 2);
+    CHECK(map["x"]->get<int>() == 3);
+    CHECK(!map["y"]);
+  }
+
+  SUBCASE("set replaces factory") {
+    lazy->set("f", 1);
+    CHECK(map["f"]->get<int>() == 1);
+    CHECK(created == 0);
+  }
+
+  SUBCASE("throwing factory") {
+    bool fail = true;
+    lazy->setFactory("g", [&]() {
+      if (fail) throw std::runtime_error("failed");
+      return 5;
+    });
+    CHECK_THROWS(map.rawGet("g"));
+    CHECK(!lazy->isMaterialized("g"));
+    fail = false;
+    CHECK(map["g"]->get<int>() == 5);
+  }
+
+  SUBCASE("context") {
+    auto root = createAnyMap();
+    root["lazy"] = map;
+    Context context;
+    context.addRootMap(root);
+    CHECK(created == 0);
+    REQUIRE(context.getTypeInfo(getTypeIndex<A>()));
+    CHECK(context.getTypeInfo(getTypeIndex<A>())->path == Context::Path{"lazy", "A"});
+    CHECK(lazy->isMaterialized("A"));
+  }
+
+  SUBCASE("context lookups") {
+    auto root = createAnyMap();
+    root["lazy"] = map;
+    Context context;
+    context.addRootMap(root);
+    const Context copy = context;
+
+    // `f` may create any class, `A` is known to create another one
+    CHECK(!copy.createInstance(Value(42)));
+    CHECK(lazy->isMaterialized("f"));
+    CHECK(!lazy->isMaterialized("A"));
+
+    std::atomic<int> mismatches{0};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+      threads.emplace_back([&]() {
+        for (int j = 0; j < 100; ++j) {
+          auto instance = copy.createInstance(Value(A{j}));
+          if (!instance || instance["method"](1).get<int>() != j + 1) ++mismatches;
+        }
+      });
+    }
+    for (auto &thread : threads) thread.join();
+    CHECK(mismatches == 0);
+    CHECK(created == 2);
+    REQUIRE(copy.getTypeInfo(getTypeIndex<std::shared_ptr<const A>>()));
+    CHECK(copy.getTypeInfo(getTypeIndex<A>())->path == Context::Path{"lazy", "A"});
+    CHECK(copy.types.count(getTypeIndex<A>()) == 0);
+
+    context.resolveLazyEntries();
+    CHECK(context.types.count(getTypeIndex<A>()) == 1);
+    CHECK(context.uniqueTypes == std::vector<TypeID>{getTypeID<A>()});
+  }
+
+  SUBCASE("removed context module") {
+    Context context;
+    context.addModule({"lazy"}, map);
+    CHECK(context.removeModule({"lazy"}));
+    CHECK(!context.getTypeInfo(getTypeIndex<A>()));
+    CHECK(created == 0);
+  }
+
+  SUBCASE("concurrent lookups") {
+    std::atomic<int> calls{0};
+    lazy->setFactory("g", [&]() {
+      ++calls;
+      return 5;
+    });
+    std::atomic<int> mismatches{0};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+      threads.emplace_back([&]() {
+        for (int j = 0; j < 100; ++j) {
+          if (map.rawGet("g")->get<int>() != 5) ++mismatches;
+        }
+      });
+    }
+    for (auto &&thread : threads) thread.join();
+    CHECK(mismatches == 0);
+    CHECK(calls == 1);
+  }
+}
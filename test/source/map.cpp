@@ -1,9 +1,12 @@
 #include <doctest/doctest.h>
+#include <glue/class.h>
 #include <glue/instance.h>
 #include <glue/keys.h>
 #include <glue/value.h>
 
 #include <algorithm>
+#include <memory_resource>
+#include <thread>
 
 using namespace glue;
 
@@ -59,6 +62,101 @@ TEST_CASE("Extended map") {
     CHECK(map2["a"]->as<int>() == 4);
     CHECK(map2["b"]->as<int>() == 2);
   }
+
+  SUBCASE("cached lookups are invalidated") {
+    map.setExtends(base);
+    auto map2 = createAnyMap();
+    map2.setExtends(map);
+    CHECK(map2["b"]->as<int>() == 2);
+    CHECK(!map2["c"]);
+
+    base["b"] = 3;
+    CHECK(map2["b"]->as<int>() == 3);
+    map["b"] = 4;
+    CHECK(map2["b"]->as<int>() == 4);
+    map2["b"] = 5;
+    CHECK(map2["b"]->as<int>() == 5);
+
+    base["c"] = 1;
+    CHECK(map2["c"]->as<int>() == 1);
+
+    auto other = createAnyMap();
+    other["c"] = 2;
+    map.setExtends(other);
+    CHECK(map2["c"]->as<int>() == 2);
+    CHECK(!map2["a"]);
+  }
+}
+
+TEST_CASE("Concurrent extends lookups") {
+  auto base = createAnyMap();
+  auto map = createAnyMap();
+  for (int i = 0; i < 64; ++i) base["k" + std::to_string(i)] = i;
+  map["own"] = -1;
+  map.setExtends(base);
+
+  std::vector<Key> keys;
+  for (int i = 0; i < 64; ++i) keys.emplace_back("k" + std::to_string(i));
+  Key missing = "missing", own = "own";
+
+  std::vector<std::thread> threads;
+  std::vector<int> errors(4, 0);
+  for (size_t t = 0; t < errors.size(); ++t) {
+    threads.emplace_back([&, t]() {
+      for (int round = 0; round < 100; ++round) {
+        for (int i = 0; i < 64; ++i) {
+          auto value = map.get(keys[size_t(i + int(t) * 16) % keys.size()]);
+          if (!value || value->get<int>() != (i + int(t) * 16) % 64) ++errors[t];
+        }
+        if (map.get(missing) || map.get(own)->get<int>() != -1) ++errors[t];
+      }
+    });
+  }
+  for (auto &thread : threads) thread.join();
+  for (auto e : errors) CHECK(e == 0);
+}
+
+TEST_CASE("Extends lookups beyond the cache limits") {
+  auto base = createAnyMap();
+  for (int i = 0; i < 2000; ++i) base["k" + std::to_string(i)] = i;
+  auto map = base;
+  for (int depth = 0; depth < 20; ++depth) {
+    auto derived = createAnyMap();
+    derived.setExtends(map);
+    map = derived;
+  }
+
+  for (int round = 0; round < 2; ++round) {
+    size_t mismatches = 0;
+    for (int i = 0; i < 2000; ++i) {
+      auto value = map.get("k" + std::to_string(i));
+      if (!value || value->get<int>() != i) ++mismatches;
+    }
+    CHECK(mismatches == 0);
+    CHECK(!map.get("missing"));
+  }
+
+  base["k0"] = -1;
+  CHECK(map.get("k0")->get<int>() == -1);
+  auto shallow = createAnyMap();
+  shallow.setExtends(base);
+  CHECK(shallow.get("k1")->get<int>() == 1);
+  base["k1"] = -2;
+  CHECK(shallow.get("k1")->get<int>() == -2);
+}
+
+TEST_CASE("Cached lookups don't keep maps alive") {
+  std::weak_ptr<Map> weak;
+  {
+    auto base = createAnyMap();
+    auto map = createAnyMap();
+    map.setExtends(base);
+    base["self"] = map;
+    CHECK(map.get("self").asMap().data == map.data);
+    weak = map.data;
+    base["self"] = 0;
+  }
+  CHECK(weak.expired());
 }
 
 TEST_CASE("Inplace creation") {
@@ -66,4 +164,66 @@ TEST_CASE("Inplace creation") {
   map["a"] = createAnyMap().setValue("x", 1).setValue("y", 2);
   CHECK(map["a"]["x"]->as<int>() == 1);
   CHECK(map["a"]["y"]->as<int>() == 2);
-}
\ No newline at end of file
+}
+
+namespace {
+
+  struct CountingResource : public std::pmr::memory_resource {
+    size_t allocated = 0;
+    size_t deallocated = 0;
+
+    void *do_allocate(size_t bytes, size_t alignment) override {
+      allocated += bytes;
+      return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override {
+      deallocated += bytes;
+      std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+      return this == &other;
+    }
+  };
+
+  struct A {
+    int value = 1;
+    int add(int x) const { return value + x; }
+  };
+
+}  // namespace
+
+TEST_CASE("Memory resources") {
+  CountingResource resource;
+
+  SUBCASE("maps") {
+    {
+      auto map = createAnyMap(&resource);
+      auto allocated = resource.allocated;
+      CHECK(allocated > 0);
+      map["a"] = 1;
+      map["b"] = createFlatMap(&resource).setValue("x", 2);
+      CHECK(resource.allocated > allocated);
+      CHECK(map["a"]->as<int>() == 1);
+      CHECK(map["b"]["x"]->as<int>() == 2);
+    }
+    CHECK(resource.deallocated == resource.allocated);
+  }
+
+  SUBCASE("arena") {
+    std::pmr::monotonic_buffer_resource arena(&resource);
+    {
+      auto root = createAnyMap(&arena);
+      root["A"] = createClass<A>(WithBases<>(), createFlatMap(&arena))
+                      .addConstructor<>()
+                      .addMethod("add", &A::add);
+      auto instance = root["A"][keys::constructorKey]();
+      CHECK(Instance(root["A"].asMap(), instance)["add"](2).get<int>() == 3);
+    }
+    CHECK(resource.allocated > 0);
+    CHECK(resource.deallocated == 0);
+    arena.release();
+    CHECK(resource.deallocated == resource.allocated);
+  }
+}
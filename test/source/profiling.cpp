@@ -0,0 +1,134 @@
+#include <doctest/doctest.h>
+#include <glue/class.h>
+#include <glue/declarations.h>
+#include <glue/profiling.h>
+
+#include <sstream>
+#include <thread>
+
+using namespace glue;
+
+namespace {
+
+  struct A {
+    int member = 1;
+    int get() const { return member; }
+  };
+
+  struct B : public A {
+    int twice() const { return 2 * member; }
+  };
+
+  const KeyProfile &find(const std::vector<Profile::Entry> &entries, const std::string &path,
+                         const std::string &key) {
+    for (auto &entry : entries) {
+      if (entry.path == path && entry.key == key) return entry.counters;
+    }
+    static KeyProfile empty;
+    return empty;
+  }
+
+}  // namespace
+
+TEST_CASE("Profiling") {
+  auto root = createAnyMap();
+  root["A"] = createClass<A>().addConstructor<>().addMethod("get", &A::get);
+  root["B"] = createClass<B>(WithBases<A>())
+                  .addConstructor<>()
+                  .addMethod("twice", &B::twice)
+                  .setExtends(root["A"]);
+  root["x"] = 1;
+
+  Profile profile;
+  auto profiled = profile.wrap(root);
+  CHECK(profile.wrap(profiled).data == profiled.data);
+
+  auto classB = profiled["B"].asMap();
+  REQUIRE(classB);
+  auto classInfo = getClassInfo(classB);
+  REQUIRE(classInfo);
+  Instance instance(classB, classInfo->converter(*classB[keys::constructorKey]()));
+  CHECK(instance["twice"]().get<int>() == 2);
+  CHECK(instance.call<int>("twice") == 2);
+  CHECK(instance["get"]().get<int>() == 1);
+  CHECK(!profiled["y"]);
+  profiled["x"] = 2;
+  CHECK(root["x"]->get<int>() == 2);
+
+  auto entries = profile.entries();
+  CHECK(find(entries, "", "B").gets == 1);
+  CHECK(find(entries, "", "y").misses == 1);
+  CHECK(find(entries, "", "y").extendsHops == 0);
+  CHECK(find(entries, "", "x").sets == 1);
+
+  auto &twice = find(entries, "B", "twice");
+  CHECK(twice.gets == 2);
+  CHECK(twice.calls == 2);
+  uint64_t histogramCalls = 0;
+  for (auto count : twice.latencyHistogram) histogramCalls += count;
+  CHECK(histogramCalls == 2);
+
+  CHECK(find(entries, "B", "get").misses == 1);
+  CHECK(find(entries, "B", "get").extendsHops == 1);
+  CHECK(find(entries, "B.__glue_extends", "get").calls == 1);
+  CHECK(find(entries, "B", keys::typedMethodsKey).gets == 0);
+
+  SUBCASE("report") {
+    std::stringstream report;
+    profile.printReport(report);
+    CHECK(report.str().find("B.twice") != std::string::npos);
+    std::stringstream json;
+    profile.printJSON(json);
+    auto expected = "{\"path\": \"B\", \"key\": \"twice\", \"gets\": 2";
+    CHECK(json.str().find(expected) != std::string::npos);
+  }
+
+  SUBCASE("cached wrappers") {
+    CHECK(profiled["B"].asMap().data == classB.data);
+    auto function = classB.rawGet("twice");
+    CHECK(classB.rawGet("twice")->type() == function->type());
+    CHECK(detail::functionIdentity(*classB.rawGet("twice")) == detail::functionIdentity(*function));
+    root["B"].asMap()["twice"] = [](const B &) { return 3; };
+    CHECK(detail::functionIdentity(*classB.rawGet("twice")) != detail::functionIdentity(*function));
+    CHECK(instance["twice"]().get<int>() == 3);
+  }
+
+  SUBCASE("extends depth") {
+    struct C : public B {};
+    root["C"] = createClass<C>(WithBases<B>()).addConstructor<>().setExtends(root["B"]);
+    auto classC = profiled["C"].asMap();
+    CHECK(classC["get"]);
+    CHECK(!classC["missing"]);
+    CHECK(find(profile.entries(), "C", "get").extendsHops == 2);
+    CHECK(find(profile.entries(), "C", "missing").extendsHops == 2);
+  }
+
+  SUBCASE("declarations") {
+    DeclarationPrinter printer;
+    std::stringstream direct, throughProfile;
+    printer.print(direct, root);
+    printer.print(throughProfile, profiled);
+    CHECK(throughProfile.str() == direct.str());
+  }
+
+  SUBCASE("concurrent lookups") {
+    profile.reset();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+      threads.emplace_back([&]() {
+        for (int j = 0; j < 100; ++j) instance["twice"]();
+      });
+    }
+    for (auto &&thread : threads) thread.join();
+    auto counters = find(profile.entries(), "B", "twice");
+    CHECK(counters.gets == 400);
+    CHECK(counters.calls == 400);
+  }
+
+  SUBCASE("reset") {
+    profile.reset();
+    CHECK(profile.entries().empty());
+    CHECK(instance["twice"]().get<int>() == 2);
+    CHECK(find(profile.entries(), "B", "twice").calls == 1);
+  }
+}
@@ -0,0 +1,96 @@
+#include <doctest/doctest.h>
+#include <glue/class.h>
+#include <glue/context.h>
+#include <glue/schema.h>
+
+#include <sstream>
+#include <vector>
+
+using namespace glue;
+
+namespace {
+
+  struct A {
+    int member = 0;
+    std::vector<int> items;
+    int add(int x) const { return member + x; }
+  };
+
+  struct B : public A {};
+
+}  // namespace
+
+TEST_CASE("Schema") {
+  auto root = createAnyMap();
+  auto inner = createAnyMap();
+  inner["A"] = createClass<A>()
+                   .addConstructor<>()
+                   .addMember("member", &A::member)
+                   .addMemberRef("items", &A::items)
+                   .addMethod("create", []() { return A(); })
+                   .addMethod("variadic", [](const AnyArguments &args) { return args.size(); });
+  root["B"] = createClass<B>(WithBases<A>()).addConstructor<>().setExtends(inner["A"]);
+  root["inner"] = inner;
+  root["value"] = 42;
+  root["f"] = [](const A &, double) { return std::string(); };
+
+  Context context;
+  context.addRootMap(root);
+
+  std::stringstream stream;
+  writeSchema(stream, root, &context);
+  auto data = stream.str();
+  SchemaView schema(data.data(), data.size());
+
+  auto &top = schema.root();
+  CHECK(top.kind == schema::NodeKind::Module);
+  REQUIRE(top.childCount == 4);
+  CHECK(schema.string(schema.child(top, 0).name) == "B");
+  CHECK(schema.string(schema.child(top, 3).name) == "value");
+  CHECK(!schema.find(top, "missing"));
+
+  auto b = schema.find(top, "B");
+  REQUIRE(b);
+  CHECK(b->kind == schema::NodeKind::Class);
+  CHECK(schema.string(schema.type(b->type).path) == "B");
+  REQUIRE(b->extends != schema::none);
+  CHECK(schema.string(schema.type(b->extends).path) == "inner.A");
+  CHECK(b->childCount == 1);
+
+  auto a = schema.find(*schema.find(top, "inner"), "A");
+  REQUIRE(a);
+  CHECK(a->extends == schema::none);
+  auto member = schema.find(*a, "member");
+  REQUIRE(member);
+  CHECK(member->kind == schema::NodeKind::Method);
+  CHECK(member->parameterCount == 0);
+  auto setter = schema.find(*a, "setMember");
+  REQUIRE(setter);
+  REQUIRE(setter->parameterCount == 1);
+  CHECK(schema.string(schema.type(schema.parameter(*setter, 0)).name)
+        == schema.string(schema.type(member->type).name));
+  CHECK(schema.find(*a, "create")->kind == schema::NodeKind::StaticMethod);
+  REQUIRE(schema.find(*a, "items"));
+  CHECK(schema.find(*a, "items")->kind == schema::NodeKind::Method);
+  CHECK(schema.find(*a, "items")->parameterCount == 0);
+  CHECK(schema.string(schema.type(schema.find(*a, "create")->type).path) == "inner.A");
+  CHECK(schema.find(*a, "__new")->kind == schema::NodeKind::Constructor);
+  CHECK(schema.find(*a, "variadic")->flags & schema::Variadic);
+  CHECK(!schema.find(*a, "__glue_class"));
+
+  auto f = schema.find(top, "f");
+  REQUIRE(f);
+  CHECK(f->kind == schema::NodeKind::Function);
+  CHECK(f->parameterCount == 2);
+  CHECK(schema.string(schema.type(schema.parameter(*f, 0)).path) == "inner.A");
+  CHECK_THROWS(schema.parameter(*f, 2));
+  CHECK(schema.find(top, "value")->kind == schema::NodeKind::Value);
+
+  SUBCASE("invalid data") {
+    CHECK_THROWS(SchemaView(data.data(), 8));
+    CHECK_THROWS(SchemaView(data.data(), data.size() - 4));
+    auto corrupted = data;
+    corrupted[0] = 'X';
+    CHECK_THROWS(SchemaView(corrupted.data(), corrupted.size()));
+  }
+}
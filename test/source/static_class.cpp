@@ -0,0 +1,116 @@
+#include <doctest/doctest.h>
+#include <glue/context.h>
+#include <glue/static_class.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+using namespace glue;
+
+namespace {
+
+  struct A {
+    int member = 0;
+    std::string name;
+    A() = default;
+    A(int m) : member(m) {}
+    int add(int x) const { return member + x; }
+    void increment() { ++member; }
+  };
+
+  struct B : public A {
+    B(int m) : A(m) {}
+    int twice() const { return 2 * member; }
+  };
+
+}  // namespace
+
+TEST_CASE("Static names") {
+  constexpr detail::StaticName getter{"value"}, setter{"value", true};
+  static_assert(setter.size() == 8);
+  static_assert(setter[3] == 'V');
+  static_assert(detail::compareNames(getter, std::string_view("value")) == 0);
+  static_assert(detail::compareNames(setter, std::string_view("setValue")) == 0);
+  static_assert(detail::compareNames(setter, std::string_view("setValues")) < 0);
+  static_assert(detail::compareNames(getter, setter) > 0);
+  CHECK(setter.str() == "setValue");
+  CHECK(getter.hash() == Key("value").hash());
+  CHECK(setter.hash() == Key("setValue").hash());
+  std::string longName(100, 'x');
+  CHECK(detail::StaticName{longName, true}.hash() == Key("setX" + longName.substr(1)).hash());
+}
+
+TEST_CASE("Static class") {
+  constexpr auto add = bind::method("add", &A::add);
+  auto map = createStaticClass<A>(bind::constructor<int>(), add,
+                                  bind::method("increment", &A::increment),
+                                  bind::member("member", &A::member),
+                                  bind::constMember("name", &A::name),
+                                  bind::method("sum", [](const A &a, int x, int y) {
+                                    return a.member + x + y;
+                                  }));
+
+  auto keys = map.keys();
+  std::sort(keys.begin(), keys.end());
+  CHECK(keys
+        == std::vector<std::string>{"__glue_class", "__glue_typed_methods", "__new", "add",
+                                    "increment", "member", "name", "setMember", "sum"});
+
+  Instance instance(map, map[keys::constructorKey](3));
+  CHECK(instance["add"](2).get<int>() == 5);
+  instance["increment"]();
+  CHECK(instance["member"]().get<int>() == 4);
+  instance["setMember"](1);
+  CHECK(instance.call<int>("member") == 1);
+  CHECK(instance.call<int>("add", 1) == 2);
+  CHECK(instance.call<int>("sum", 1, 2) == 4);
+  CHECK(instance["name"]().get<std::string>() == "");
+  CHECK(!map["setName"]);
+  CHECK(!map["missing"]);
+  CHECK(!map[""]);
+  CHECK(map.find("sum"));
+  CHECK(map.find("setMember"));
+  CHECK(!map.find("setName"));
+  CHECK(map.rawGet(keys::classKey)->get<ClassInfo>().typeID == getTypeID<A>());
+  CHECK_THROWS(map["add"] = 1);
+
+  SUBCASE("extends") {
+    auto mapB = createStaticClass<B>(WithBases<A>(), bind::constructor<int>(),
+                                     bind::method("twice", &B::twice));
+    mapB.setExtends(map);
+    Context context;
+    auto root = createAnyMap();
+    root["A"] = map;
+    root["B"] = mapB;
+    context.addRootMap(root);
+    auto b = context.createInstance(mapB[keys::constructorKey](3));
+    CHECK(b.classMap.data == mapB.data);
+    CHECK(b["twice"]().get<int>() == 6);
+    CHECK(b["add"](1).get<int>() == 4);
+    CHECK(b.call<int>("add", 1) == 4);
+  }
+
+  SUBCASE("duplicate names") {
+    auto overridden = createStaticClass<A>(bind::method("f", [](const A &) { return 1; }),
+                                           bind::method("f", [](const A &) { return 2; }));
+    CHECK(overridden.keys().size() == 3);
+    CHECK(Instance(overridden, A()).call<int>("f") == 2);
+    CHECK(Instance(overridden, A())["f"]().get<int>() == 2);
+  }
+
+  SUBCASE("concurrent lookups") {
+    std::atomic<int> mismatches{0};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+      threads.emplace_back([&]() {
+        for (int j = 0; j < 100; ++j) {
+          if (!map.rawGet("setMember") || !map.rawGet(keys::classKey)) ++mismatches;
+          if (map.rawGet("setName")) ++mismatches;
+        }
+      });
+    }
+    for (auto &&thread : threads) thread.join();
+    CHECK(mismatches == 0);
+  }
+}